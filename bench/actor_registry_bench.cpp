@@ -0,0 +1,88 @@
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "actor.hpp"
+#include "bench.hpp"
+#include "dbvt_broadphase.hpp"
+
+// Checks that handles keep naming the right actors while a third of 100k of
+// them are destroyed and replaced, then times the broadphase moving them: as
+// it went before, actor by actor through their facades, and as it goes now,
+// over the registry's arrays; refitting the DBVT after is timed on its own
+int benchActorRegistry() {
+  constexpr size_t count{100000};
+  constexpr int steps{20};
+  constexpr float timeStep{1 / 60.0f};
+  std::mt19937 rng{42};
+  TriangleMesh cube{TriangleMeshData::cube()};
+  auto &registry{ActorRegistry::instance()};
+
+  std::vector<std::unique_ptr<Actor>> actors;
+  for (size_t i = 0; i < count; ++i) {
+    auto &actor{actors.emplace_back(
+        std::make_unique<Actor>(std::to_string(i), &cube))};
+    actor->bound();
+    actor->setPosition({float(i), 0, 0});
+    actor->initializeRigidBody(1);
+  }
+  std::vector<ActorRegistry::Handle> stale;
+  for (size_t i = 0; i < count; i += 3) {
+    auto j{std::uniform_int_distribution<size_t>{0, count - 1}(rng)};
+    stale.push_back(actors[j]->handle());
+    actors[j] = std::make_unique<Actor>(*actors[i]);
+    actors[j]->translate({0, float(j), 0});
+  }
+  auto consistent{[&] {
+    bool consistent{registry.size() == count};
+    for (auto &actor : actors) {
+      auto slot{registry.slot(actor->handle())};
+      auto position{actor->position()};
+      // cubes are centered on their origins
+      consistent &= registry.actors()[slot] == actor.get() &&
+                    distance(registry.bounds()[slot].center(), position) <
+                        1e-6f * (1 + length(position));
+    }
+    // replaced actors' handles are stale, even with their entries reused
+    for (auto handle : stale) consistent &= !registry.valid(handle);
+    return consistent;
+  }};
+  auto handlesHold{consistent()};
+
+  std::vector<Actor *> pointers;
+  for (auto &actor : actors) pointers.push_back(actor.get());
+  DbvtBroadphase broadphase{pointers};
+  // what integrate() did before walking the registry, but for refitting,
+  // which is the same either way and timed on its own
+  auto facadeMs{timeMs([&] {
+    for (int step = 0; step < steps; ++step) {
+      for (auto actor : pointers) {
+        auto &body{actor->body()};
+        static constexpr vec3 gravity{0, -0.0005, 0};
+        if (body._inverseMass > 0) body._velocity += gravity * timeStep;
+        actor->translate(body._velocity);
+        actor->rotate(body._angularVelocity);
+      }
+    }
+  })};
+  auto registryMs{timeMs([&] {
+    for (int step = 0; step < steps; ++step) broadphase.move(timeStep);
+  })};
+  auto refitMs{timeMs([&] {
+    for (int step = 0; step < steps; ++step) broadphase.refit();
+  })};
+
+  printf("%zu actors\n", count);
+  printf("%12s %12s %12s\n", "", "ms / step", "speedup");
+  printf("%12s %12.3f %11.2fx\n", "facades", facadeMs / steps, 1.0);
+  printf("%12s %12.3f %11.2fx\n", "registry", registryMs / steps,
+         facadeMs / registryMs);
+  printf("%12s %12.3f\n", "refit", refitMs / steps);
+  if (!handlesHold || !consistent()) {
+    puts("FAILED: handles don't name the right actors");
+    return 1;
+  }
+  return 0;
+}
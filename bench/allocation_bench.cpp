@@ -0,0 +1,119 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "dbvt_broadphase.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "object_pool.hpp"
+#include "occlusion.hpp"
+#include "render_queue.hpp"
+#include "scene_generators.hpp"
+
+// allocations made by the benchmarks go through here to be counted, arrays
+// too, as their operators forward here; over-aligned ones aren't counted
+static std::atomic<size_t> allocations;
+
+void *operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto memory{std::malloc(size ? size : 1)}) return memory;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+
+void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+
+namespace {
+
+struct Counts {
+  double ms;
+  size_t allocations;
+};
+
+// runs f warmup times, for whatever it keeps to settle, then counts the
+// allocations of the next runs
+template <class F>
+Counts count(unsigned warmup, unsigned runs, F f) {
+  using namespace std::chrono;
+  for (unsigned i = 0; i < warmup; ++i) f();
+  auto before{allocations.load()};
+  auto start{steady_clock::now()};
+  for (unsigned i = 0; i < runs; ++i) f();
+  auto end{steady_clock::now()};
+  return {duration_cast<nanoseconds>(end - start).count() / 1e6 / runs,
+          allocations.load() - before};
+}
+
+}  // namespace
+
+// Counts the heap allocations of steady-state frames, which should be none:
+// physics steps of a pile of falling cubes, whose pairs, contacts and
+// traversal stacks come from the broadphase's arena, occlusion culling, whose
+// scratch comes from the culler's, the render queue built and sorted as a
+// frame does, with texture paths too long to be stored inline, and actors
+// made and destroyed over and over in a pool. Batching the queue isn't
+// counted, as it writes straight into GL buffers
+int benchAllocations() {
+  constexpr unsigned warmup{300}, runs{300};
+  int status{};
+  printf("%12s %12s %12s\n", "", "ms / frame", "allocations");
+  auto report{[&](const char *name, Counts counts) {
+    printf("%12s %12.3f %12zu\n", name, counts.ms, counts.allocations);
+    if (counts.allocations) {
+      printf("FAILED: %s allocates in steady state\n", name);
+      status = 1;
+    }
+  }};
+
+  auto scene{makeFallingCubes(1000, 1)};
+  DbvtBroadphase broadphase{scene->pointers()};
+  report("physics",
+         count(warmup, runs, [&] { broadphase.collide(1 / 60.0f); }));
+
+  // the scene's cubes seen from above, the plane and a few of them hiding
+  // the rest
+  std::vector<const Actor *> occluders, actors, visible;
+  for (auto &actor : scene->actors) actors.push_back(actor.get());
+  occluders.push_back(actors.back());
+  for (size_t i = 0; i < actors.size(); i += 100)
+    occluders.push_back(actors[i]);
+  visible.reserve(actors.size());
+  auto viewProjection{
+      glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 500.0f) *
+      glm::lookAt(vec3{0, 150, 10}, vec3{0}, vec3{0, 1, 0})};
+  OcclusionCuller culler;
+  report("occlusion", count(warmup, runs, [&] {
+           culler.render(occluders, viewProjection);
+           visible = actors;
+           culler.cull(visible);
+         }));
+
+  for (size_t i = 0; i < actors.size(); ++i)
+    scene->actors[i]->material().map_Kd =
+        "assets/textures/a_texture_of_many_characters_" +
+        std::to_string(i % 8) + ".png";
+  RenderQueue queue;
+  report("queue", count(warmup, runs, [&] {
+           queue.clear();
+           for (auto actor : actors)
+             queue.push(actor, RenderQueue::opaque, 0,
+                        distance(actor->position(), vec3{0, 150, 10}));
+           queue.sort();
+         }));
+
+  ObjectPool<Actor> pool;
+  std::vector<Actor *> pooled;
+  pooled.reserve(1000);
+  report("pool", count(warmup, runs, [&] {
+           for (int i = 0; i < 1000; ++i)
+             pooled.push_back(pool.create("cube", scene->cube.get()));
+           for (auto actor : pooled) pool.destroy(actor);
+           pooled.clear();
+         }));
+  return status;
+}
@@ -0,0 +1,102 @@
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "physics/particle_force_registry.hpp"
+#include "physics/particle_nbody_gravity.hpp"
+
+// Compares the Barnes-Hut octree against the O(n^2) sum on a uniformly filled
+// sphere, reporting timings and the RMS of the relative force error; checks
+// that, driven by a ParticleForceRegistry, the octree follows the particles
+// from one step to the next
+int benchBarnesHut() {
+  constexpr size_t counts[]{1000, 4000, 16000};
+  constexpr phys::Float angles[]{0.3, 0.5, 0.7, 1.0};
+  // brute force reference is evaluated on a subset to keep the run short
+  constexpr size_t samples{500};
+
+  printf("%8s %6s %10s %10s %10s %10s %8s\n", "n", "theta", "build ms",
+         "eval ms", "brute ms", "speedup", "rms err");
+
+  for (auto n : counts) {
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<phys::Float> u{-1, 1}, m{0.5, 2};
+    std::vector<phys::Particle> particles(n);
+    for (auto &particle : particles) {
+      phys::Vector3 p;
+      do p = {u(rng), u(rng), u(rng)};
+      while (glm::dot(p, p) > 1);
+      particle.SetPosition(p);
+      particle.SetMass(m(rng));
+    }
+
+    phys::ParticleNBodyGravity gravity{0.5, 1};
+    for (auto &particle : particles) gravity.AddParticle(&particle);
+
+    std::vector<phys::Vector3> reference(samples);
+    auto stride{n / samples};
+    auto bruteMs{timeMs(
+        [&] {
+          for (size_t i = 0; i < samples; ++i)
+            reference[i] =
+                gravity.ComputeForceBruteForce(&particles[i * stride]);
+        },
+        1)};
+    // extrapolated to the whole set
+    bruteMs *= double(n) / samples;
+
+    for (auto theta : angles) {
+      gravity.SetOpeningAngle(theta);
+      auto buildMs{timeMs([&] { gravity.BuildTree(); })};
+      auto evalMs{timeMs([&] {
+        for (auto &particle : particles) particle.ClearForceAccumulator();
+        gravity.ApplyForces(0);
+      }) - buildMs};
+
+      double error{};
+      for (size_t i = 0; i < samples; ++i) {
+        auto f{gravity.ComputeForce(&particles[i * stride])};
+        auto d{f - reference[i]};
+        error += glm::dot(d, d) / glm::dot(reference[i], reference[i]);
+      }
+      error = std::sqrt(error / samples);
+
+      printf("%8zu %6.2f %10.3f %10.3f %10.3f %9.1fx %8.2e\n", n, double(theta),
+             buildMs, evalMs, bruteMs, bruteMs / (buildMs + evalMs), error);
+    }
+  }
+
+  // two registry steps, the sphere tripling in size in between
+  std::mt19937 rng{42};
+  std::uniform_real_distribution<phys::Float> u{-1, 1};
+  std::vector<phys::Particle> particles(1000);
+  phys::ParticleNBodyGravity gravity{0.5, 1};
+  phys::ParticleForceRegistry registry;
+  for (auto &particle : particles) {
+    particle.SetPosition({u(rng), u(rng), u(rng)});
+    particle.SetMass(1);
+    gravity.AddParticle(&particle);
+    registry.Register(&particle, &gravity);
+  }
+  registry.ApplyForces(0);
+  for (auto &particle : particles) {
+    particle.SetPosition(phys::Float(3) * particle.GetPosition());
+    particle.ClearForceAccumulator();
+  }
+  registry.ApplyForces(0);
+  double error{};
+  for (auto &particle : particles) {
+    auto reference{gravity.ComputeForceBruteForce(&particle)};
+    auto d{particle.GetForces() - reference};
+    error += glm::dot(d, d) / glm::dot(reference, reference);
+  }
+  error = std::sqrt(error / double(particles.size()));
+  printf("registry rms err after moving %8.2e\n", error);
+  if (error > 1e-2) {
+    puts("FAILED: the registry evaluates a stale octree");
+    return 1;
+  }
+  return 0;
+}
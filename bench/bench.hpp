@@ -0,0 +1,41 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <functional>
+
+// best wall time, in milliseconds, out of a few runs of f
+inline double timeMs(const std::function<void()> &f, int runs = 3) {
+  using namespace std::chrono;
+  double best{1e300};
+  for (int i = 0; i < runs; ++i) {
+    auto start{steady_clock::now()};
+    f();
+    auto end{steady_clock::now()};
+    best = std::min(best,
+                    duration_cast<nanoseconds>(end - start).count() / 1e6);
+  }
+  return best;
+}
+
+// stores value's bytes where the compiler must assume they're read, so that
+// whatever computed it isn't optimized away
+template <class T>
+void consume(const T &value) {
+  static volatile unsigned char sink;
+  auto bytes{reinterpret_cast<const unsigned char *>(&value)};
+  for (size_t i = 0; i < sizeof(T); ++i) sink = bytes[i];
+}
+
+// every benchmark returns 0 on success, or nonzero if some check failed
+int benchActorRegistry();
+int benchAllocations();
+int benchBarnesHut();
+int benchBounds();
+int benchDbvh();
+int benchJobSystem();
+int benchOcclusion();
+int benchSceneGraph();
+int benchTransforms();
+
+#endif  // BENCH_HPP
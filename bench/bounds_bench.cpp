@@ -0,0 +1,108 @@
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "actor.hpp"
+#include "bench.hpp"
+
+namespace {
+
+// what Actor::bound() used to do: transform every vertex
+Aabb bruteForceBounds(const Actor &actor) {
+  Aabb box;
+  for (auto &v : actor.mesh()->vertices())
+    box.inflate(vec3{actor.transform() * vec4{v, 1}});
+  return box;
+}
+
+bool contains(const Aabb &outer, const Aabb &inner, float slack) {
+  return all(lessThanEqual(outer.a, inner.a + slack)) &&
+         all(greaterThanEqual(outer.b, inner.b - slack));
+}
+
+// points spread through a ball, so that only about their square root lie on
+// their hull
+TriangleMeshData pointCloud(size_t count, std::mt19937 &rng) {
+  std::uniform_real_distribution<float> coordinate{-1, 1};
+  TriangleMeshData data;
+  while (data.vertices.size() < count) {
+    vec3 p{coordinate(rng), coordinate(rng), coordinate(rng)};
+    if (dot(p, p) <= 1) data.addVertex(p);
+  }
+  return data;
+}
+
+}  // namespace
+
+// Checks that fast bounds contain the brute-force box and that tight ones
+// match it over many random poses, then times rebounding each way on a mesh
+// of a million vertices
+int benchBounds() {
+  int status{};
+  std::mt19937 rng{42};
+  std::uniform_real_distribution<float> angle{0, 6.283f}, scale{0.2f, 5},
+      offset{-100, 100};
+
+  struct Case {
+    const char *name;
+    std::unique_ptr<TriangleMesh> mesh;
+  };
+  Case cases[]{
+      {"cube", std::make_unique<TriangleMesh>(TriangleMeshData::cube())},
+      {"plane", std::make_unique<TriangleMesh>(TriangleMeshData::plane())},
+      {"cloud", std::make_unique<TriangleMesh>(pointCloud(1 << 20, rng))},
+  };
+
+  printf("%8s %10s %8s %12s %12s %12s %12s %10s\n", "mesh", "vertices",
+         "hull", "hull ms", "brute us", "fast us", "tight us", "fast/tight");
+  for (auto &[name, mesh] : cases) {
+    Actor actor{name, mesh.get()};
+    auto hullMs{timeMs([&] { mesh->hull(); }, 1)};
+
+    // how much bigger fast boxes are than tight ones, by volume
+    double looseness{};
+    constexpr int poses{100};
+    for (int i = 0; i < poses; ++i) {
+      actor.setPosition({offset(rng), offset(rng), offset(rng)});
+      actor.setScale({scale(rng), scale(rng), scale(rng)});
+      actor.setRotation({angle(rng), angle(rng), angle(rng)});
+      auto exact{bruteForceBounds(actor)};
+      auto slack{1e-4f * (1 + length(exact.size()) + length(exact.center()))};
+
+      actor.setBoundsMode(Actor::BoundsMode::fast);
+      auto fast{actor.bounds()};
+      actor.setBoundsMode(Actor::BoundsMode::tight);
+      auto tight{actor.bounds()};
+      if (!contains(fast, exact, slack) || !contains(tight, exact, slack) ||
+          !contains(exact, tight, slack)) {
+        printf("FAILED: %s bounds don't match the mesh\n", name);
+        status = 1;
+        break;
+      }
+      auto volume{[](const Aabb &box) {
+        auto size{box.size()};
+        return double(size.x) * size.y * size.z;
+      }};
+      looseness += volume(fast) / std::max(volume(tight), 1e-30) / poses;
+    }
+
+    auto perCall{[&](auto &&f) {
+      constexpr int calls{100};
+      return 1e3 * timeMs([&] {
+               for (int i = 0; i < calls; ++i) f();
+             }) /
+             calls;
+    }};
+    auto bruteUs{perCall([&] { bruteForceBounds(actor); })};
+    actor.setBoundsMode(Actor::BoundsMode::fast);
+    auto fastUs{perCall([&] { actor.bound(); })};
+    actor.setBoundsMode(Actor::BoundsMode::tight);
+    auto tightUs{perCall([&] { actor.bound(); })};
+    printf("%8s %10zu %8zu %12.3f %12.3f %12.3f %12.3f %9.2fx\n", name,
+           mesh->vertices().size(), mesh->hull().size(), hullMs, bruteUs,
+           fastUs, tightUs, looseness);
+  }
+  return status;
+}
@@ -0,0 +1,118 @@
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "dbvh.hpp"
+
+namespace {
+
+float area(const Aabb &box) {
+  auto size{box.size()};
+  return size.x * size.y + size.x * size.z + size.y * size.z;
+}
+
+// the area of every inner node relative to the root's, the usual estimate of
+// how many nodes a random ray visits
+float sahCost(const DBVH &dbvh) {
+  float cost{};
+  dbvh.visit([&](int, const DBVH::Node &node) {
+    if (!node.isLeaf()) cost += area(node.aabb);
+  });
+  return cost / area(dbvh.nodes()[dbvh.root()].aabb);
+}
+
+// every leaf is reached once from the root, parents point back at their
+// children, and boxes contain their children's
+bool isValid(const DBVH &dbvh, size_t leafCount) {
+  auto &nodes{dbvh.nodes()};
+  if (nodes.size() != 2 * leafCount - 1) return false;
+  if (nodes[dbvh.root()].parent != DBVH::null) return false;
+  size_t leaves{};
+  bool valid{true};
+  auto contains{[](const Aabb &outer, const Aabb &inner) {
+    return all(lessThanEqual(outer.a, inner.a)) &&
+           all(greaterThanEqual(outer.b, inner.b));
+  }};
+  dbvh.visit([&](int index, const DBVH::Node &node) {
+    if (node.isLeaf()) {
+      leaves += node.object != nullptr;
+      return;
+    }
+    for (auto child : {node.left, node.right})
+      valid &= nodes[child].parent == index &&
+               contains(node.aabb, nodes[child].aabb);
+  });
+  return valid && leaves == leafCount;
+}
+
+// what DBVH used to do: merge the two clusters whose centers are closest,
+// found by comparing every pair, until one is left; O(n^3)
+float greedySahCost(const std::vector<Actor *> &actors) {
+  std::vector<Aabb> clusters;
+  for (auto actor : actors) clusters.push_back(actor->bounds());
+  float cost{};
+  while (clusters.size() > 1) {
+    auto minSqDist{FLT_MAX};
+    size_t i1{}, i2{};
+    for (size_t i = 0; i < clusters.size(); ++i) {
+      for (size_t j = i + 1; j < clusters.size(); ++j) {
+        auto d{clusters[i].center() - clusters[j].center()};
+        if (dot(d, d) < minSqDist) {
+          minSqDist = dot(d, d);
+          i1 = i;
+          i2 = j;
+        }
+      }
+    }
+    clusters[i1].inflate(clusters[i2]);
+    cost += area(clusters[i1]);
+    clusters.erase(clusters.begin() + i2);
+  }
+  return cost / area(clusters[0]);
+}
+
+}  // namespace
+
+// Builds DBVHs over growing numbers of randomly scattered cubes, checking
+// their structure and showing that the build time per n log n stays flat;
+// the old greedy build, timed on the smallest sizes, grows as n^3
+int benchDbvh() {
+  int status{};
+  auto cube{std::make_unique<TriangleMesh>(TriangleMeshData::cube())};
+  std::mt19937 rng{42};
+  std::uniform_real_distribution<float> position{-100, 100}, scale{0.2f, 4};
+
+  printf("%8s %10s %16s %10s %10s %10s\n", "actors", "ms",
+         "ns / (n log n)", "sah", "greedy ms", "greedy sah");
+  for (size_t count : {256, 512, 4096, 16384, 65536, 262144}) {
+    std::vector<std::unique_ptr<Actor>> owned;
+    std::vector<Actor *> actors;
+    for (size_t i = 0; i < count; ++i) {
+      auto &actor{owned.emplace_back(std::make_unique<Actor>(
+          "cube_" + std::to_string(i), cube.get()))};
+      actor->setScale(vec3{scale(rng), scale(rng), scale(rng)});
+      actor->setPosition({position(rng), position(rng), position(rng)});
+      actors.push_back(actor.get());
+    }
+
+    std::unique_ptr<DBVH> dbvh;
+    auto ms{timeMs([&] { dbvh = std::make_unique<DBVH>(actors); })};
+    auto valid{isValid(*dbvh, count)};
+    status |= !valid;
+    auto n{double(count)};
+    printf("%8zu %10.3f %16.2f %10.1f", count, ms,
+           1e6 * ms / (n * std::log2(n)), sahCost(*dbvh));
+    if (count <= 512) {
+      float greedyCost{};
+      auto greedyMs{timeMs([&] { greedyCost = greedySahCost(actors); }, 1)};
+      printf(" %10.3f %10.1f", greedyMs, greedyCost);
+    }
+    puts(valid ? "" : "  FAILED: malformed tree");
+  }
+  return status;
+}
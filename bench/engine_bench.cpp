@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TriangleMeshBVH.h"
+#include "dbvt_broadphase.hpp"
+#include "job_system.hpp"
+#include "scene_generators.hpp"
+
+// Runs procedurally generated scenes through the engine's simulation and
+// import code, without a window, and writes per-stage timings as JSON, for
+// builds to be compared on the same seed:
+//
+//   EngineBench [--seed n] [--steps n] [--scale x] [--obj file]
+//               [--out file] [cubes] [springs] [obj]
+//
+// Scenes given by name run alone. --scale multiplies every scene's size, and
+// --obj imports the given file rather than a generated terrain.
+
+namespace {
+
+struct Options {
+  uint32_t seed{42};
+  unsigned steps{300};
+  double scale{1};
+  std::string objFile, outFile{"engine_bench.json"};
+  std::vector<std::string> scenes;
+};
+
+// milliseconds every stage took at every step of a run
+class StageTimes {
+ public:
+  template <class F>
+  void time(const char *stage, F &&f) {
+    using namespace std::chrono;
+    auto start{steady_clock::now()};
+    f();
+    auto end{steady_clock::now()};
+    _find(stage).push_back(duration<double, std::milli>(end - start).count());
+  }
+
+  double totalMs() const {
+    double total{};
+    for (auto &[name, ms] : _stages)
+      for (auto sample : ms) total += sample;
+    return total;
+  }
+
+  void writeJson(std::ostream &os) const {
+    os << "[";
+    for (size_t i = 0; i < _stages.size(); ++i) {
+      auto ms{_stages[i].second};
+      std::sort(ms.begin(), ms.end());
+      double total{};
+      for (auto sample : ms) total += sample;
+      auto percentile{[&](double p) {
+        return ms[size_t(p * double(ms.size() - 1))];
+      }};
+      os << (i ? "," : "") << "\n      {\"name\": \"" << _stages[i].first
+         << "\", \"total_ms\": " << total
+         << ", \"mean_ms\": " << total / double(ms.size())
+         << ", \"p50_ms\": " << percentile(0.5)
+         << ", \"p95_ms\": " << percentile(0.95)
+         << ", \"max_ms\": " << ms.back() << "}";
+    }
+    os << "\n    ]";
+  }
+
+ private:
+  std::vector<double> &_find(const char *stage) {
+    for (auto &[name, ms] : _stages)
+      if (name == stage) return ms;
+    return _stages.emplace_back(stage, std::vector<double>{}).second;
+  }
+
+  // in the order they first ran
+  std::vector<std::pair<std::string, std::vector<double>>> _stages;
+};
+
+struct SceneResult {
+  std::string name;
+  size_t size;  // in the scene's own unit
+  unsigned steps;
+  StageTimes stages;
+  // what the scene processes per step, and how much of it there was
+  const char *unit;
+  double itemsPerStep;
+  std::vector<std::pair<const char *, double>> counters;
+};
+
+SceneResult runCubes(const Options &options) {
+  auto count{size_t(1000 * options.scale)};
+  SceneResult result{"cubes", count, options.steps};
+  auto scene{makeFallingCubes(count, options.seed)};
+  DbvtBroadphase broadphase{scene->pointers()};
+
+  constexpr float timeStep{1 / 60.0f};
+  double pairs{}, contacts{};
+  for (unsigned i = 0; i < options.steps; ++i) {
+    result.stages.time("broadphase", [&] { broadphase.findPairs(); });
+    result.stages.time("narrow phase", [&] { broadphase.narrowPhase(); });
+    result.stages.time("resolution", [&] { broadphase.resolve(timeStep); });
+    result.stages.time("integration",
+                       [&] { broadphase.integrate(timeStep); });
+    pairs += double(broadphase.pairs.size());
+    for (auto &list : broadphase.contacts) contacts += double(list.size());
+  }
+  result.unit = "actors";
+  result.itemsPerStep = double(scene->actors.size());
+  result.counters = {{"pairs_per_step", pairs / options.steps},
+                     {"contacts_per_step", contacts / options.steps}};
+  return result;
+}
+
+SceneResult runSprings(const Options &options) {
+  auto side{size_t(64 * std::sqrt(options.scale))};
+  SceneResult result{"springs", side * side, options.steps};
+  auto grid{makeSpringGrid(side, options.seed)};
+
+  constexpr phys::Float timeStep{1 / 60.0f};
+  auto &particles{grid->particles};
+  for (unsigned i = 0; i < options.steps; ++i) {
+    result.stages.time("forces",
+                       [&] { grid->registry.ApplyForces(timeStep); });
+    result.stages.time("integration", [&] {
+      JobSystem::instance().parallelFor(
+          0, particles.size(), 256, [&](size_t first, size_t last) {
+            for (auto j = first; j < last; ++j) {
+              particles[j].Integrate(timeStep);
+              particles[j].ClearForceAccumulator();
+            }
+          });
+    });
+  }
+  result.unit = "particles";
+  result.itemsPerStep = double(particles.size());
+  result.counters = {{"springs", double(grid->springs.size())}};
+  return result;
+}
+
+// importing is far slower than a simulation step, so it is only repeated a
+// few times
+SceneResult runObj(const Options &options) {
+  constexpr unsigned repeats{3};
+  auto side{size_t(512 * std::sqrt(options.scale))};
+  auto file{options.objFile.empty()
+                ? writeTerrainObj(side, options.seed,
+                                  std::filesystem::temp_directory_path())
+                : std::filesystem::path{options.objFile}};
+
+  SceneResult result{"obj", 0, repeats};
+  size_t triangles{}, nodes{};
+  for (unsigned i = 0; i < repeats; ++i) {
+    std::unique_ptr<TriangleMesh> mesh;
+    result.stages.time("import", [&] {
+      mesh = std::make_unique<TriangleMesh>(
+          TriangleMeshData::fromObj(file.string()));
+    });
+    Actor actor{"obj", mesh.get()};
+    result.stages.time("bvh build", [&] {
+      auto &vertices{mesh->vertices()};
+      cg::TriangleMeshBVH::PrimitiveArray primitives;
+      primitives.reserve(mesh->triangles().size());
+      for (auto &t : mesh->triangles())
+        primitives.push_back({vertices[t.v1], vertices[t.v2], vertices[t.v3]});
+      cg::TriangleMeshBVH bvh{&actor, std::move(primitives)};
+      nodes = bvh.size();
+    });
+    triangles = mesh->triangles().size();
+  }
+  if (options.objFile.empty()) std::filesystem::remove(file);
+
+  result.size = triangles;
+  result.unit = "triangles";
+  result.itemsPerStep = double(triangles);
+  result.counters = {{"bvh_nodes", double(nodes)}};
+  return result;
+}
+
+bool writeJson(const Options &options,
+               const std::vector<SceneResult> &results) {
+  std::ofstream os{options.outFile};
+  os << "{\n  \"seed\": " << options.seed
+     << ",\n  \"threads\": " << JobSystem::instance().threadCount()
+#ifdef NDEBUG
+     << ",\n  \"build\": \"release\""
+#else
+     << ",\n  \"build\": \"debug\""
+#endif
+     << ",\n  \"scenes\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto &result{results[i]};
+    auto totalMs{result.stages.totalMs()};
+    os << (i ? "," : "") << "\n    {\"name\": \"" << result.name
+       << "\", \"size\": " << result.size << ", \"steps\": " << result.steps
+       << ", \"total_ms\": " << totalMs
+       << ", \"steps_per_s\": " << 1e3 * result.steps / totalMs
+       << ", \"unit\": \"" << result.unit << "\", \"" << result.unit
+       << "_per_s\": " << 1e3 * result.itemsPerStep * result.steps / totalMs;
+    for (auto &[name, value] : result.counters)
+      os << ", \"" << name << "\": " << value;
+    os << ",\n    \"stages\": ";
+    result.stages.writeJson(os);
+    os << "}";
+  }
+  os << "\n  ]\n}\n";
+  return bool(os);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    auto arg{argv[i]};
+    auto value{[&] {
+      if (i + 1 == argc) {
+        fprintf(stderr, "%s needs a value\n", arg);
+        exit(1);
+      }
+      return argv[++i];
+    }};
+    if (!strcmp(arg, "--seed"))
+      options.seed = uint32_t(std::stoul(value()));
+    else if (!strcmp(arg, "--steps"))
+      options.steps = unsigned(std::stoul(value()));
+    else if (!strcmp(arg, "--scale"))
+      options.scale = std::stod(value());
+    else if (!strcmp(arg, "--obj"))
+      options.objFile = value();
+    else if (!strcmp(arg, "--out"))
+      options.outFile = value();
+    else
+      options.scenes.push_back(arg);
+  }
+
+  struct Scene {
+    const char *name;
+    SceneResult (*run)(const Options &options);
+  };
+  static constexpr Scene scenes[]{
+      {"cubes", runCubes},
+      {"springs", runSprings},
+      {"obj", runObj},
+  };
+
+  std::vector<SceneResult> results;
+  for (auto &scene : scenes) {
+    if (!options.scenes.empty() &&
+        std::find(options.scenes.begin(), options.scenes.end(), scene.name) ==
+            options.scenes.end())
+      continue;
+    auto &result{results.emplace_back(scene.run(options))};
+    printf("%-8s %10zu %-9s %6u steps %10.3f ms\n", result.name.c_str(),
+           result.size, result.unit, result.steps, result.stages.totalMs());
+  }
+
+  if (!writeJson(options, results)) {
+    fprintf(stderr, "couldn't write %s\n", options.outFile.c_str());
+    return 1;
+  }
+  return 0;
+}
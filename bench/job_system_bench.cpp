@@ -0,0 +1,99 @@
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "job_system.hpp"
+
+// Checks that parallel loops cover their ranges exactly once, nested ones
+// included, and that dependencies hold jobs back, then measures what spawning
+// and stealing jobs costs, and how a parallel loop scales with its grain
+int benchJobSystem() {
+  auto &jobs{JobSystem::instance()};
+  printf("%u threads\n", jobs.threadCount());
+  int status{};
+
+  std::vector<int> hits(1 << 20);
+  jobs.parallelFor(0, hits.size(), 100, [&](size_t first, size_t last) {
+    for (auto i = first; i < last; ++i) ++hits[i];
+  });
+  for (auto hit : hits) status |= hit != 1;
+
+  std::atomic<size_t> nested{};
+  jobs.parallelFor(0, 64, 1, [&](size_t first, size_t last) {
+    for (auto i = first; i < last; ++i)
+      jobs.parallelFor(0, 1000, 10, [&](size_t first, size_t last) {
+        nested += last - first;
+      });
+  });
+  status |= nested != 64 * 1000;
+
+  // a diamond: b and c wait on a, d waits on both
+  std::atomic<int> a{};
+  int b{}, c{}, d{};
+  auto root{jobs.create([] {})};
+  auto jobA{jobs.create([&] { a = 1; })}, jobB{jobs.create([&] { b = a; })},
+      jobC{jobs.create([&] { c = a; })};
+  auto jobD{jobs.create([&] { d = b + c; }, root)};
+  jobs.addDependency(jobB, jobA);
+  jobs.addDependency(jobC, jobA);
+  jobs.addDependency(jobD, jobB);
+  jobs.addDependency(jobD, jobC);
+  for (auto job : {jobD, jobC, jobB, root, jobA}) jobs.run(job);
+  jobs.wait(root);
+  status |= d != 2;
+
+  if (status) puts("FAILED: jobs ran the wrong number of times, or too soon");
+
+  // empty jobs, in batches that keep clear of the ring's capacity
+  constexpr int batches{200}, batchSize{2000};
+  auto spawn{[&] {
+    for (int i = 0; i < batches; ++i) {
+      auto batch{jobs.create([] {})};
+      for (int j = 0; j < batchSize; ++j) jobs.run(jobs.create([] {}, batch));
+      jobs.run(batch);
+      jobs.wait(batch);
+    }
+  }};
+  auto before{jobs.stats()};
+  auto spawnMs{timeMs(spawn)};
+  auto after{jobs.stats()};
+  auto executed{after.executed - before.executed};
+  auto stolen{after.stolen - before.stolen};
+  printf("spawn + run: %.1f ns per job, %.1f%% of %llu stolen\n",
+         1e6 * spawnMs / (batches * (batchSize + 1)),
+         executed ? 100.0 * double(stolen) / double(executed) : 0.0,
+         (unsigned long long)executed);
+
+  // jobs only thieves can get to: the spawning thread spins until the others
+  // have emptied its deque, without running anything itself
+  if (jobs.threadCount() > 1) {
+    auto stealMs{timeMs([&] {
+      for (int i = 0; i < batches; ++i) {
+        std::atomic<int> left{batchSize};
+        for (int j = 0; j < batchSize; ++j)
+          jobs.run(jobs.create([&] { --left; }));
+        while (left) std::this_thread::yield();
+      }
+    })};
+    printf("steal + run: %.1f ns per job\n",
+           1e6 * stealMs / (batches * batchSize));
+  }
+
+  // a loop of cheap iterations at growing grains, against running it serially
+  std::vector<float> values(1 << 22);
+  auto work{[&](size_t first, size_t last) {
+    for (auto i = first; i < last; ++i)
+      values[i] = std::sqrt(float(i)) * 0.5f + values[i] * 0.5f;
+  }};
+  auto serialMs{timeMs([&] { work(0, values.size()); })};
+  printf("%10s %10s %10s\n", "grain", "ms", "speedup");
+  printf("%10s %10.3f %9.2fx\n", "serial", serialMs, 1.0);
+  for (size_t grain : {64, 1024, 16384, 262144}) {
+    auto ms{timeMs([&] { jobs.parallelFor(0, values.size(), grain, work); })};
+    printf("%10zu %10.3f %9.2fx\n", grain, ms, serialMs / ms);
+  }
+  return status;
+}
@@ -0,0 +1,35 @@
+#include <cstdio>
+#include <cstring>
+
+#include "bench.hpp"
+
+struct Benchmark {
+  const char *name;
+  int (*run)();
+};
+
+static constexpr Benchmark benchmarks[]{
+    {"actor_registry", benchActorRegistry},
+    {"allocations", benchAllocations},
+    {"barnes_hut", benchBarnesHut},
+    {"bounds", benchBounds},
+    {"dbvh", benchDbvh},
+    {"job_system", benchJobSystem},
+    {"occlusion", benchOcclusion},
+    {"scene_graph", benchSceneGraph},
+    {"transforms", benchTransforms},
+};
+
+// runs every benchmark, or only the ones named in the command line
+int main(int argc, char **argv) {
+  int status{};
+  for (auto &benchmark : benchmarks) {
+    bool selected{argc < 2};
+    for (int i = 1; i < argc; ++i)
+      selected |= strcmp(argv[i], benchmark.name) == 0;
+    if (!selected) continue;
+    printf("== %s\n", benchmark.name);
+    status |= benchmark.run();
+  }
+  return status;
+}
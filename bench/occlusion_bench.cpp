@@ -0,0 +1,155 @@
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "occlusion.hpp"
+
+// brute-force counterpart of OcclusionCuller: the same triangles rasterized
+// one pixel at a time over the whole screen, and boxes tested pixel by pixel
+// without the pyramid
+struct ReferenceOcclusion {
+  static constexpr auto width{OcclusionCuller::width};
+  static constexpr auto height{OcclusionCuller::height};
+
+  void render(const std::vector<OcclusionCuller::Triangle> &triangles) {
+    depth.assign(width * height, 1.0f);
+    for (auto &t : triangles) {
+      for (int y = 0; y < height; ++y) {
+        auto py{y + 0.5f};
+        for (int x = 0; x < width; ++x) {
+          auto px{float(x) + 0.5f};
+          bool inside{true};
+          for (int e = 0; e < 3; ++e)
+            inside &= t.edgeA[e] * px + (t.edgeB[e] * py + t.edgeC[e]) > 0;
+          if (!inside) continue;
+          auto z{t.depthA * px + (t.depthB * py + t.depthC)};
+          depth[y * width + x] = std::min(depth[y * width + x], z);
+        }
+      }
+    }
+  }
+
+  bool isVisible(const Aabb &bounds, const mat4 &viewProjection) const {
+    vec2 lo{1e30f}, hi{-1e30f};
+    auto nearest{1.0f};
+    for (int i = 0; i < 8; ++i) {
+      vec3 corner{i & 1 ? bounds.b.x : bounds.a.x,
+                  i & 2 ? bounds.b.y : bounds.a.y,
+                  i & 4 ? bounds.b.z : bounds.a.z};
+      auto c{viewProjection * vec4{corner, 1}};
+      if (c.z < -c.w) return true;
+      vec3 ndc{vec3{c} / c.w};
+      lo = min(lo, vec2{(0.5f * ndc.x + 0.5f) * width,
+                        (0.5f * ndc.y + 0.5f) * height});
+      hi = max(hi, vec2{(0.5f * ndc.x + 0.5f) * width,
+                        (0.5f * ndc.y + 0.5f) * height});
+      nearest = std::min(nearest, 0.5f * ndc.z + 0.5f);
+    }
+    // every pixel the projection touches
+    auto x0{std::max(int(std::floor(std::max(lo.x, -1.0f))), 0)};
+    auto y0{std::max(int(std::floor(std::max(lo.y, -1.0f))), 0)};
+    auto x1{std::min(int(std::floor(std::min(hi.x, 1e6f))), width - 1)};
+    auto y1{std::min(int(std::floor(std::min(hi.y, 1e6f))), height - 1)};
+    for (int y = y0; y <= y1; ++y)
+      for (int x = x0; x <= x1; ++x)
+        if (depth[y * width + x] >= nearest) return true;
+    return false;
+  }
+
+  std::vector<float> depth;
+};
+
+// Renders a few walls in front of a field of small cubes, checking that the
+// tiled SIMD rasterizer matches the reference depth buffer and that the
+// pyramid never hides a cube the per-pixel test finds visible
+int benchOcclusion() {
+  constexpr size_t counts[]{1000, 10000, 50000};
+  int status{};
+
+  auto cube{new TriangleMesh{TriangleMeshData::cube()}};
+  auto projection{glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 200.0f)};
+
+  printf("%8s %6s %10s %10s %10s %8s %8s %8s %10s\n", "n", "view",
+         "render ms", "test ms", "brute ms", "visible", "ref", "extra",
+         "max depth");
+
+  for (auto n : counts) {
+    std::mt19937 rng{7};
+    std::uniform_real_distribution<float> u{-60, 60}, depth{-120, -5};
+
+    // reserved up front, as actors don't carry their bounds when moved
+    std::vector<Actor> walls, actors;
+    walls.reserve(6);
+    std::vector<const Actor *> occluders;
+    for (int i = 0; i < 6; ++i) {
+      auto &wall{walls.emplace_back("wall", cube)};
+      wall.setScale({20 + 10 * (i % 3), 15, 1});
+      wall.setPosition({-45 + 18 * i, 0, -20 - 5 * (i % 2)});
+      wall.setOccluder(true);
+      occluders.push_back(&wall);
+    }
+    actors.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+      auto &actor{actors.emplace_back("cube", cube)};
+      actor.bound();
+      actor.setPosition({u(rng), 0.25f * u(rng), depth(rng)});
+    }
+
+    // looking straight at the walls, then from the side
+    const vec3 eyes[]{{0, 0, 0}, {50, 10, 0}};
+    for (int v = 0; v < 2; ++v) {
+      auto viewProjection{
+          projection * glm::lookAt(eyes[v], vec3{0, 0, -40}, vec3{0, 1, 0})};
+
+      OcclusionCuller culler;
+      auto renderMs{timeMs([&] { culler.render(occluders, viewProjection); })};
+
+      std::vector<const Actor *> visible;
+      auto testMs{timeMs([&] {
+        visible.clear();
+        for (auto &actor : actors) visible.push_back(&actor);
+        culler.cull(visible);
+      })};
+
+      ReferenceOcclusion reference;
+      std::vector<const Actor *> referenceVisible;
+      auto bruteMs{timeMs(
+          [&] {
+            reference.render(culler.triangles());
+            referenceVisible.clear();
+            for (auto &actor : actors)
+              if (reference.isVisible(actor.bounds(), viewProjection))
+                referenceVisible.push_back(&actor);
+          },
+          1)};
+
+      float maxDepthError{};
+      for (size_t i = 0; i < reference.depth.size(); ++i)
+        maxDepthError = std::max(
+            maxDepthError,
+            std::abs(reference.depth[i] - culler.depthBuffer()[i]));
+
+      std::vector<char> isVisible(n);
+      for (auto actor : visible) isVisible[actor - actors.data()] = true;
+      size_t missing{};
+      for (auto actor : referenceVisible)
+        missing += !isVisible[actor - actors.data()];
+
+      printf("%8zu %6s %10.3f %10.3f %10.1f %8zu %8zu %8zu %10.2e\n", n,
+             v == 0 ? "front" : "side", renderMs, testMs, bruteMs,
+             visible.size(), referenceVisible.size(),
+             visible.size() - referenceVisible.size(), maxDepthError);
+      if (missing || maxDepthError > 1e-6f) {
+        printf("FAILED: %zu visible actors culled, depth off by %g\n",
+               missing, maxDepthError);
+        status = 1;
+      }
+    }
+  }
+
+  delete cube;
+  return status;
+}
@@ -0,0 +1,136 @@
+#include "scene_generators.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <string>
+
+// std::uniform_real_distribution is free to differ between standard
+// libraries, so numbers are drawn straight from the engine, whose output is
+// fixed by the standard
+static float uniform(std::mt19937 &rng, float lo, float hi) {
+  return lo + (hi - lo) * float(rng() >> 8) / float(1 << 24);
+}
+
+std::vector<Actor *> FallingCubes::pointers() const {
+  std::vector<Actor *> pointers;
+  for (auto &actor : actors) pointers.push_back(actor.get());
+  return pointers;
+}
+
+std::unique_ptr<FallingCubes> makeFallingCubes(size_t count, uint32_t seed) {
+  std::mt19937 rng{seed};
+  auto scene{std::make_unique<FallingCubes>()};
+  scene->cube = std::make_unique<TriangleMesh>(TriangleMeshData::cube());
+  scene->plane = std::make_unique<TriangleMesh>(TriangleMeshData::plane());
+
+  // cubes fill a column whose footprint grows with their count
+  auto extent{std::max(2.0f, std::sqrt(float(count)))};
+  for (size_t i = 0; i < count; ++i) {
+    auto &cube{scene->actors.emplace_back(std::make_unique<Actor>(
+        "cube_" + std::to_string(i), scene->cube.get()))};
+    cube->setScale(vec3{uniform(rng, 0.5f, 1.5f)});
+    // radians
+    cube->setRotation({uniform(rng, 0, 6.283f), uniform(rng, 0, 6.283f),
+                       uniform(rng, 0, 6.283f)});
+    cube->setPosition({uniform(rng, -extent, extent),
+                       uniform(rng, 2, 2 + 4 * extent),
+                       uniform(rng, -extent, extent)});
+    cube->initializeRigidBody(1);
+    cube->body()._angularVelocity = {uniform(rng, -0.02f, 0.02f),
+                                     uniform(rng, -0.02f, 0.02f),
+                                     uniform(rng, -0.02f, 0.02f)};
+  }
+
+  auto &plane{scene->actors.emplace_back(
+      std::make_unique<Actor>("plane", scene->plane.get()))};
+  plane->setScale({2 * extent, 1, 2 * extent});
+  plane->initializeRigidBody(0);
+  return scene;
+}
+
+std::unique_ptr<SpringGrid> makeSpringGrid(size_t side, uint32_t seed) {
+  std::mt19937 rng{seed};
+  auto grid{std::make_unique<SpringGrid>()};
+  constexpr phys::Float spacing{0.5}, stiffness{10};
+
+  grid->particles.resize(side * side);
+  for (size_t y = 0; y < side; ++y) {
+    for (size_t x = 0; x < side; ++x) {
+      auto &particle{grid->particles[y * side + x]};
+      // slightly off the rest pose, so that the springs have work to do
+      auto jitter{uniform(rng, -0.1f, 0.1f)};
+      particle.SetPosition({spacing * phys::Float(x) + jitter,
+                            -spacing * phys::Float(y),
+                            uniform(rng, -0.1f, 0.1f)});
+      particle.SetMass(uniform(rng, 0.5f, 2));
+      if (y == 0) particle.SetInverseMass(0);
+    }
+  }
+
+  // springs only pull the particle they are registered for, so every link
+  // takes two, one each way
+  auto link{[&](phys::Particle &a, phys::Particle &b) {
+    auto &toA{grid->springs.emplace_back(
+        std::make_unique<phys::ParticleSpring>(&a, spacing, stiffness))};
+    grid->registry.Register(&b, toA.get());
+    auto &toB{grid->springs.emplace_back(
+        std::make_unique<phys::ParticleSpring>(&b, spacing, stiffness))};
+    grid->registry.Register(&a, toB.get());
+  }};
+  for (size_t y = 0; y < side; ++y) {
+    for (size_t x = 0; x < side; ++x) {
+      auto &particle{grid->particles[y * side + x]};
+      grid->registry.Register(&particle, &grid->gravity);
+      grid->registry.Register(&particle, &grid->drag);
+      if (x + 1 < side) link(particle, grid->particles[y * side + x + 1]);
+      if (y + 1 < side) link(particle, grid->particles[(y + 1) * side + x]);
+    }
+  }
+  return grid;
+}
+
+std::filesystem::path writeTerrainObj(size_t side, uint32_t seed,
+                                      const std::filesystem::path &directory) {
+  std::mt19937 rng{seed};
+  // a sum of a few random waves
+  constexpr int waveCount{8};
+  vec4 waves[waveCount];
+  for (auto &wave : waves)
+    wave = {uniform(rng, -0.2f, 0.2f), uniform(rng, -0.2f, 0.2f),
+            uniform(rng, 0, 6.3f), uniform(rng, 0.5f, 2)};
+  auto height{[&](float x, float z) {
+    float h{};
+    for (auto &w : waves) h += w.w * std::sin(w.x * x + w.y * z + w.z);
+    return h;
+  }};
+
+  auto path{directory / ("terrain_" + std::to_string(side) + "_" +
+                         std::to_string(seed) + ".obj")};
+  std::ofstream os{path};
+  os << "# terrain generated by the engine benchmark\n";
+  for (size_t z = 0; z < side; ++z)
+    for (size_t x = 0; x < side; ++x)
+      os << "v " << float(x) << ' ' << height(float(x), float(z)) << ' '
+         << float(z) << '\n';
+  for (size_t z = 0; z < side; ++z) {
+    for (size_t x = 0; x < side; ++x) {
+      // central differences
+      auto dx{height(float(x) + 1, float(z)) - height(float(x) - 1, float(z))};
+      auto dz{height(float(x), float(z) + 1) - height(float(x), float(z) - 1)};
+      auto n{normalize(vec3{-dx, 2, -dz})};
+      os << "vn " << n.x << ' ' << n.y << ' ' << n.z << '\n';
+    }
+  }
+  // OBJ indices start at 1
+  for (size_t z = 0; z + 1 < side; ++z) {
+    for (size_t x = 0; x + 1 < side; ++x) {
+      auto a{z * side + x + 1}, b{a + 1}, c{a + side}, d{c + 1};
+      os << "f " << a << "//" << a << ' ' << c << "//" << c << ' ' << b
+         << "//" << b << '\n';
+      os << "f " << b << "//" << b << ' ' << c << "//" << c << ' ' << d
+         << "//" << d << '\n';
+    }
+  }
+  return path;
+}
@@ -0,0 +1,46 @@
+#ifndef SCENE_GENERATORS_HPP
+#define SCENE_GENERATORS_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "actor.hpp"
+#include "physics/particle.hpp"
+#include "physics/particle_force_generator.hpp"
+#include "physics/particle_force_registry.hpp"
+#include "triangle_mesh.hpp"
+
+// Scenes for the engine benchmark, built procedurally from a seed, so that
+// the same seed and size make the same scene on every run and build.
+
+// count cubes of random sizes and spins, scattered above a plane they fall on
+struct FallingCubes {
+  std::unique_ptr<TriangleMesh> cube, plane;
+  std::vector<std::unique_ptr<Actor>> actors;  // the plane last
+
+  std::vector<Actor *> pointers() const;
+};
+
+std::unique_ptr<FallingCubes> makeFallingCubes(size_t count, uint32_t seed);
+
+// a side x side cloth of particles tied to their neighbors by springs, hanging
+// from its top row, under gravity and drag
+struct SpringGrid {
+  std::vector<phys::Particle> particles;
+  std::vector<std::unique_ptr<phys::ParticleSpring>> springs;
+  phys::ParticleGravity gravity;
+  phys::ParticleDrag drag;
+  phys::ParticleForceRegistry registry;
+};
+
+std::unique_ptr<SpringGrid> makeSpringGrid(size_t side, uint32_t seed);
+
+// a side x side heightfield of random hills, written as an OBJ file of
+// 2 (side - 1)^2 triangles into directory, to be imported back; returns its
+// path
+std::filesystem::path writeTerrainObj(size_t side, uint32_t seed,
+                                      const std::filesystem::path &directory);
+
+#endif  // SCENE_GENERATORS_HPP
@@ -0,0 +1,132 @@
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "scene_graph.hpp"
+
+namespace {
+
+// a thousand roots of a hundred nodes each: eleven children under every
+// root, eight grandchildren under every child
+struct Forest {
+  Forest(SceneGraph &graph) {
+    constexpr int roots{1000}, children{11}, grandchildren{8};
+    auto add{[&](int parent) {
+      auto index{int(objects.size())};
+      objects.push_back(std::make_unique<TransformableObject>(""));
+      parents.push_back(parent);
+      graph.add(objects.back().get());
+      if (parent >= 0)
+        graph.setParent(objects.back().get(), objects[parent].get());
+      return index;
+    }};
+    for (int r = 0; r < roots; ++r) {
+      auto root{add(-1)};
+      for (int c = 0; c < children; ++c) {
+        auto child{add(root)};
+        for (int g = 0; g < grandchildren; ++g) add(child);
+      }
+    }
+  }
+
+  // the product of the local transforms up to the root, as attached objects
+  // had to be placed before there were parents
+  mat4 world(int index) const {
+    mat4 m{1};
+    for (auto i{index}; i >= 0; i = parents[i]) m = objects[i]->transform() * m;
+    return m;
+  }
+
+  float maxError() const {
+    float error{};
+    for (int i = 0; i < int(objects.size()); ++i) {
+      if (!objects[i]) continue;
+      auto expected{world(i)};
+      auto &actual{objects[i]->worldTransform()};
+      for (int c = 0; c < 4; ++c)
+        for (int r = 0; r < 4; ++r)
+          error = std::max(error, std::abs(actual[c][r] - expected[c][r]));
+    }
+    return error;
+  }
+
+  std::vector<std::unique_ptr<TransformableObject>> objects;
+  std::vector<int> parents;
+};
+
+}  // namespace
+
+// Moves a tenth of the roots of a 100k-node forest and a hundredth of all its
+// nodes every frame, then brings every world matrix up to date, both by
+// multiplying up every node's chain of parents and by sweeping the scene
+// graph; checks the graph against the products, also after reparenting and
+// removing nodes
+int benchSceneGraph() {
+  constexpr int frames{10};
+  SceneGraph graph;
+  Forest forest{graph};
+  auto count{forest.objects.size()};
+  std::mt19937 rng{42};
+  std::uniform_int_distribution<size_t> pick{0, count - 1};
+  std::uniform_real_distribution<float> step{-0.01f, 0.01f};
+  graph.update();
+
+  // objects deleted further down are skipped
+  auto move{[&] {
+    for (size_t i = 0; i < count / 100; ++i) {
+      if (auto &object{forest.objects[pick(rng)]}) {
+        object->translate({step(rng), step(rng), step(rng)});
+        object->rotate({step(rng), step(rng), step(rng)});
+      }
+    }
+    for (size_t i = 0; i < count; i += 1000)
+      forest.objects[i + pick(rng) % 10 * 100]->translate(
+          {step(rng), step(rng), step(rng)});
+  }};
+  mat4 sink{};  // keeps the products from being optimized away
+  auto chainMs{timeMs([&] {
+    for (int frame = 0; frame < frames; ++frame) {
+      move();
+      for (size_t i = 0; i < count; ++i) sink += forest.world(int(i));
+    }
+  }, 1)};
+  auto graphMs{timeMs([&] {
+    for (int frame = 0; frame < frames; ++frame) {
+      move();
+      graph.update();
+    }
+  }, 1)};
+
+  printf("%zu nodes, %zu roots\n", count, count / 100);
+  printf("%12s %12s %12s\n", "", "ms / frame", "speedup");
+  printf("%12s %12.3f %11.2fx\n", "chains", chainMs / frames, 1.0);
+  printf("%12s %12.3f %11.2fx\n", "scene graph", graphMs / frames,
+         chainMs / graphMs);
+  auto error{forest.maxError()};
+
+  // the first child of every tenth root moves under the next root, and the
+  // second child of every hundredth root is deleted, its children becoming
+  // roots
+  for (size_t i = 0; i + 100 < count; i += 1000) {
+    graph.setParent(forest.objects[i + 1].get(), forest.objects[i + 100].get());
+    forest.parents[i + 1] = int(i + 100);
+  }
+  for (size_t i = 10; i < count; i += 10000) {
+    for (auto &parent : forest.parents)
+      if (parent == int(i)) parent = -1;
+    forest.objects[i].reset();
+  }
+  move();
+  auto updateMs{timeMs([&] { graph.update(); }, 1)};
+  error = std::max(error, forest.maxError());
+  printf("restructured update %.3f ms\n", updateMs);
+  printf("max difference %g (%g)\n", error, sink[0][0]);
+  if (error > 1e-3f) {
+    puts("FAILED: the world matrices disagree");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,114 @@
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "transformable_object.hpp"
+
+namespace {
+
+// how TransformableObject used to work: a single matrix, with the scale
+// measured back out of it on every rotation
+struct MatrixTransform {
+  vec3 scale() const {
+    return {length(m[0]), length(m[1]), length(m[2])};
+  }
+
+  void translate(vec3 xyz) { m[3] += vec4{xyz, 0}; }
+
+  void rotate(vec3 euler) {
+    auto cx{std::cos(euler.x)}, sx{std::sin(euler.x)}, cy{std::cos(euler.y)},
+        sy{std::sin(euler.y)}, cz{std::cos(euler.z)}, sz{std::sin(euler.z)};
+    mat4 rx{1, 0, 0, 0, 0, cx, -sx, 0, 0, sx, cx, 0, 0, 0, 0, 1};
+    mat4 ry{cy, 0, sy, 0, 0, 1, 0, 0, -sy, 0, cy, 0, 0, 0, 0, 1};
+    mat4 rz{cz, -sz, 0, 0, sz, cz, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    auto s{scale()};
+    vec3 position{m[3]};
+    translate(-position);
+    m[0] /= s.x;
+    m[1] /= s.y;
+    m[2] /= s.z;
+    m = rz * ry * rx * m;
+    m[0] *= s.x;
+    m[1] *= s.y;
+    m[2] *= s.z;
+    translate(position);
+  }
+
+  void setScale(vec3 xyz) {
+    auto s{xyz / scale()};
+    m[0] *= s.x;
+    m[1] *= s.y;
+    m[2] *= s.z;
+  }
+
+  mat4 m{1};
+};
+
+}  // namespace
+
+// Moves, spins and rescales 100k objects a frame, then reads every matrix
+// back as rendering would, against the old matrix-only transforms; checks
+// that both end up with the same matrices
+int benchTransforms() {
+  constexpr size_t count{100000};
+  constexpr int frames{10};
+  std::mt19937 rng{42};
+  std::uniform_real_distribution<float> step{-0.01f, 0.01f};
+  std::vector<vec3> velocities(count), spins(count);
+  for (size_t i = 0; i < count; ++i) {
+    velocities[i] = {step(rng), step(rng), step(rng)};
+    spins[i] = {step(rng), step(rng), step(rng)};
+  }
+
+  std::vector<MatrixTransform> matrices(count);
+  std::vector<TransformableObject> objects(count, TransformableObject{""});
+  mat4 sink{};  // keeps the reads from being optimized away
+
+  // every object is edited a few times before its matrix is needed, as when
+  // physics, animation and the editor all touch it in a frame
+  auto legacyMs{timeMs([&] {
+    for (int frame = 0; frame < frames; ++frame) {
+      for (size_t i = 0; i < count; ++i) {
+        auto &m{matrices[i]};
+        m.translate(velocities[i]);
+        m.rotate(spins[i]);
+        m.setScale(vec3{1 + 0.1f * std::sin(float(frame))});
+        m.rotate(spins[i]);
+      }
+      for (auto &m : matrices) sink += m.m;
+    }
+  }, 1)};
+  auto decomposedMs{timeMs([&] {
+    for (int frame = 0; frame < frames; ++frame) {
+      for (size_t i = 0; i < count; ++i) {
+        auto &o{objects[i]};
+        o.translate(velocities[i]);
+        o.rotate(spins[i]);
+        o.setScale(vec3{1 + 0.1f * std::sin(float(frame))});
+        o.rotate(spins[i]);
+      }
+      for (auto &o : objects) sink += o.transform();
+    }
+  }, 1)};
+
+  float maxError{};
+  for (size_t i = 0; i < count; ++i)
+    for (int c = 0; c < 4; ++c)
+      for (int r = 0; r < 4; ++r)
+        maxError = std::max(maxError, std::abs(objects[i].transform()[c][r] -
+                                               matrices[i].m[c][r]));
+  printf("%zu objects, %d edits each per frame\n", count, 4);
+  printf("%12s %12s %12s\n", "", "ms / frame", "speedup");
+  printf("%12s %12.3f %11.2fx\n", "matrix", legacyMs / frames, 1.0);
+  printf("%12s %12.3f %11.2fx\n", "decomposed", decomposedMs / frames,
+         legacyMs / decomposedMs);
+  printf("max difference %g\n", maxError);
+  consume(sink);
+  if (maxError > 1e-3f) {
+    puts("FAILED: the transforms disagree");
+    return 1;
+  }
+  return 0;
+}
@@ -16,6 +16,11 @@
  * 3. This notice may not be removed or altered from any source distribution.
  */
 
+// Altered: out-of-class definitions made inline so that the header can be
+// included by more than one translation unit, update() added to move a leaf
+// without reallocating it, node storage released with the operator delete
+// matching its allocation, and a dangling reference fixed in addLeafNode().
+
 #ifndef __DynamicTree_h
 #define __DynamicTree_h
 
@@ -25,7 +30,7 @@
 #include <stack>
 
 #include "aabb.hpp"
-#include "glm.hpp"
+#include "glm/glm.hpp"
 
 namespace cg { // begin namespace cg
 
@@ -140,7 +145,7 @@ private:
 
 }; // DynamicTreeIterator
 
-DynamicTreeIterator &DynamicTreeIterator::operator++() {
+inline DynamicTreeIterator &DynamicTreeIterator::operator++() {
   if (_index != Node::null) {
     const auto node = _nodes + _index;
     auto nextIndex = node->children[0];
@@ -177,12 +182,13 @@ public:
   using bounds_type = Aabb;
   using iterator = DynamicTreeIterator;
 
-  ~DynamicTree() { delete[] _nodes; }
+  ~DynamicTree() { ::operator delete(_nodes); }
 
   DynamicTree();
 
   int add(const bounds_type &bounds, void *userData = nullptr);
   void remove(int index);
+  void update(int index, const bounds_type &bounds);
 
   auto nodeCount() const { return _nodeCount; }
 
@@ -231,7 +237,7 @@ private:
 
 }; // DynamicTree
 
-DynamicTree::DynamicTree() : _nodes{nullptr} {
+inline DynamicTree::DynamicTree() : _nodes{nullptr} {
   _root = _freeList = Node::null;
   _nodeCount = _nodeCapacity = 0;
 }
@@ -244,7 +250,7 @@ inline void DynamicTree::resize() {
     _nodes = allocateNodes(_nodeCapacity);
     if (temp != nullptr) {
       memcpy(_nodes, temp, _nodeCount * sizeof(Node));
-      delete[] temp;
+      ::operator delete(temp);
     }
   }
 
@@ -259,7 +265,7 @@ inline void DynamicTree::resize() {
   _freeList = _nodeCount;
 }
 
-int DynamicTree::allocateNode() {
+inline int DynamicTree::allocateNode() {
   if (_freeList == Node::null)
     resize();
 
@@ -273,14 +279,14 @@ int DynamicTree::allocateNode() {
   return index;
 }
 
-void DynamicTree::freeNode(int index) {
+inline void DynamicTree::freeNode(int index) {
   _nodes[index]._next = _freeList;
   _nodes[index]._height = -1;
   _freeList = index;
   --_nodeCount;
 }
 
-int DynamicTree::add(const bounds_type &bounds, void *userData) {
+inline int DynamicTree::add(const bounds_type &bounds, void *userData) {
   auto leaf = allocateNode();
 
   _nodes[leaf].bounds = bounds;
@@ -289,7 +295,7 @@ int DynamicTree::add(const bounds_type &bounds, void *userData) {
   return leaf;
 }
 
-void DynamicTree::remove(int index) {
+inline void DynamicTree::remove(int index) {
   assert(0 <= index && index < _nodeCapacity);
   assert(_nodes[index].isLeaf());
 
@@ -297,14 +303,26 @@ void DynamicTree::remove(int index) {
   freeNode(index);
 }
 
-void DynamicTree::addLeafNode(int leaf) {
+inline void DynamicTree::update(int index, const bounds_type &bounds) {
+  assert(0 <= index && index < _nodeCapacity);
+  assert(_nodes[index].isLeaf());
+
+  // Reinsert the leaf so that the tree stays well balanced
+  removeLeafNode(index);
+  _nodes[index]._parent = Node::null;
+  _nodes[index].bounds = bounds;
+  addLeafNode(index);
+}
+
+inline void DynamicTree::addLeafNode(int leaf) {
   if (_root == Node::null) {
     _root = leaf;
     return;
   }
 
   // Find the best sibling for this node
-  const auto &leafBounds = _nodes[leaf].bounds;
+  // A copy, as allocating the new parent may move the nodes
+  const auto leafBounds = _nodes[leaf].bounds;
   auto index = _root;
 
   for (Node *node; !(node = _nodes + index)->isLeaf();) {
@@ -381,7 +399,7 @@ void DynamicTree::addLeafNode(int leaf) {
   }
 }
 
-void DynamicTree::removeLeafNode(int leaf) {
+inline void DynamicTree::removeLeafNode(int leaf) {
   if (_root == leaf) {
     _root = Node::null;
     return;
@@ -426,7 +444,7 @@ void DynamicTree::removeLeafNode(int leaf) {
 
 // Perform a left or right rotation if node A is imbalanced.
 // Return the new root index.
-int DynamicTree::balance(int iA) {
+inline int DynamicTree::balance(int iA) {
   assert(iA != Node::null);
 
   auto a = _nodes + iA;
@@ -36,6 +36,7 @@
 #include "SharedObject.h"
 #include "aabb.hpp"
 
+#include <atomic>
 #include <cassert>
 #include <cinttypes>
 #include <functional>
@@ -93,7 +94,10 @@ protected:
   }
 
 private:
-  uint32_t _nodeCount{};
+  // ranges smaller than this are not worth building on another thread
+  static constexpr uint32_t minPrimitivesPerJob{4096};
+
+  std::atomic<uint32_t> _nodeCount{}; // changed from uint32_t
   uint32_t _maxPrimitivesPerNode;
 
   Node *makeNode(PrimitiveInfoArray &, uint32_t, uint32_t, IndexArray &);
@@ -48,9 +48,9 @@ class TriangleMeshBVH final : public BVH<Triangle<vec3>> {
 public:
   TriangleMeshBVH(Actor *actor, PrimitiveArray &&, uint32_t = 64);
 
-  const cg::Reference<TriangleMesh> mesh() const { return _actor->mesh; }
+  const cg::Reference<TriangleMesh> mesh() const { return _actor->mesh(); }
 
-  cg::Reference<TriangleMesh> mesh() { return _actor->mesh; }
+  cg::Reference<TriangleMesh> mesh() { return _actor->mesh(); }
 
   auto actor() { return _actor; }
 
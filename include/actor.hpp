@@ -1,20 +1,33 @@
 #ifndef ACTOR_HPP
 #define ACTOR_HPP
 
+#include "actor_registry.hpp"
 #include "material.hpp"
 #include "rigid_body.hpp"
 #include "transformable_object.hpp"
 #include "triangle_mesh.hpp"
 
-class Actor : public TransformableObject, public RigidBody {
+// A handle on an entity of ActorRegistry, where its bounds, rigid body,
+// material, mesh and world transform are kept; only what the per-frame loops
+// don't read, like its name and local transform, stays in the actor.
+class Actor : public TransformableObject {
  public:
+  // fast bounds transform the mesh's local box, and are loose on rotated
+  // actors; tight ones transform the mesh's convex hull, and fit exactly
+  enum class BoundsMode { fast, tight };
+
   Actor(std::string name, const TriangleMesh *mesh);
   Actor(std::string name, Material m);
+  // a new entity, with the same components
   Actor(const Actor &other);
+  // takes the entity over; other is left without one, only to be assigned to
+  // or destroyed
   Actor(Actor &&other) noexcept;
+  ~Actor() override;
 
   void translate(vec3 xyz) override;
   void rotate(vec3 euler) override;
+  void rotate(float angle, vec3 axis) override;
   void scale(vec3 xyz) override;
   void scale(float s) override;
 
@@ -25,11 +38,52 @@ class Actor : public TransformableObject, public RigidBody {
   Actor &operator=(const Actor &other);
   Actor &operator=(Actor &&other) noexcept;
 
-  void bound() override;
-  void initializeRigidBody(float mass) override;
+  // bound() must be called when the mesh is changed, and is called by
+  // transformations otherwise
+  void bound();
+  bool isBound() const;
+  Aabb bounds() const;
+
+  // what a physics step does to the actor: translates it, rotates it and
+  // rebounds it, all at once; slot must be its own, as found by whoever walks
+  // the registry, and spares looking it up again
+  void advance(size_t slot, vec3 translation, vec3 euler);
+
+  void initializeRigidBody(float mass);
+
+  BoundsMode boundsMode() const;
+  void setBoundsMode(BoundsMode mode);
+
+  ActorRegistry::Handle handle() const { return _handle; }
+  size_t slot() const { return _registry().slot(_handle); }
+
+  RigidBody &body() { return _registry().bodies()[slot()]; }
+  const RigidBody &body() const { return _registry().bodies()[slot()]; }
+  Material &material() { return _registry().materials()[slot()]; }
+  const Material &material() const {
+    return _registry().materials()[slot()];
+  }
+  const TriangleMesh *mesh() const { return _registry().meshes()[slot()]; }
+  // hides what is behind it in the occlusion pass
+  bool occluder() const { return _registry().occluders()[slot()]; }
+  void setOccluder(bool occluder) {
+    _registry().occluders()[slot()] = occluder;
+  }
+
+ protected:
+  void _worldChanged() override;
+
+ private:
+  static ActorRegistry &_registry() { return ActorRegistry::instance(); }
+  // the transform component has to be copied again
+  void _moved();
+  void _bound(size_t slot);
+  // all but the transform, which is the object's
+  void _copyComponents(const Actor &other);
 
-  Material material{};
-  const TriangleMesh *mesh;
+  ActorRegistry::Handle _handle;
+  BoundsMode _boundsMode{BoundsMode::fast};
+  bool _isBound{};
 };
 
 #endif  // ACTOR_HPP
\ No newline at end of file
@@ -0,0 +1,99 @@
+#ifndef ACTOR_REGISTRY_HPP
+#define ACTOR_REGISTRY_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "aabb.hpp"
+#include "custom_assert.hpp"
+#include "material.hpp"
+#include "rigid_body.hpp"
+#include "triangle_mesh.hpp"
+
+class Actor;
+struct DbvtBroadphase;
+
+// Where actors keep the state that the per-frame loops read: one dense array
+// per component, all indexed alike, so that a loop over the actors streams
+// through memory rather than hopping between heap objects. Actors are named
+// by handles, which stay valid while others come and go; a destroyed actor's
+// place is taken by the last one, keeping the arrays dense, so places (slots)
+// are only good until the next destruction.
+//
+// Creating and destroying actors isn't thread-safe; neither is writing to the
+// same actor's components from several threads.
+class ActorRegistry {
+public:
+  struct Handle {
+    bool operator==(const Handle &) const = default;
+
+    uint32_t index{~0u}, generation{};
+  };
+
+  // an actor's leaf in the DBVT of the broadphase it is in, if any
+  struct Proxy {
+    const DbvtBroadphase *broadphase;
+    int leaf;
+  };
+
+  // every actor is created in this one, as jobs all go to the one JobSystem
+  static ActorRegistry &instance();
+
+  Handle create(Actor *actor);
+  void destroy(Handle handle);
+  // whether handle names an actor that hasn't been destroyed
+  bool valid(Handle handle) const {
+    return handle.index < _entries.size() &&
+           _entries[handle.index].generation == handle.generation;
+  }
+  // its components are the slot-th entries of every array
+  size_t slot(Handle handle) const {
+    ASSERT(valid(handle), "actor handle %u:%u is null or stale\n",
+           handle.index, handle.generation);
+    return _entries[handle.index].slot;
+  }
+  size_t size() const { return _actors.size(); }
+
+  // world transforms, as of the last syncTransforms()
+  std::span<const mat4> transforms() const { return _transforms; }
+  std::span<Aabb> bounds() { return _bounds; }
+  std::span<RigidBody> bodies() { return _bodies; }
+  std::span<Material> materials() { return _materials; }
+  std::span<const TriangleMesh *> meshes() { return _meshes; }
+  // whether each actor hides what is behind it in the occlusion pass
+  std::span<char> occluders() { return _occluders; }
+  // an actor is in one broadphase at a time
+  std::span<Proxy> proxies() { return _proxies; }
+  std::span<Actor *const> actors() const { return _actors; }
+
+  // copies the world transforms of the actors moved since the last call
+  // into transforms(), composing them in parallel
+  void syncTransforms();
+
+private:
+  friend class Actor;
+
+  struct Entry {
+    size_t slot;
+    uint32_t generation{};
+  };
+
+  // the transform in the slot has to be copied again
+  void _moved(size_t slot) { _stale[slot] = true; }
+
+  std::vector<Entry> _entries; // by handle index
+  std::vector<uint32_t> _free; // indices of destroyed actors' entries
+  // by slot
+  std::vector<Handle> _handles;
+  std::vector<Actor *> _actors;
+  std::vector<mat4> _transforms;
+  std::vector<Aabb> _bounds;
+  std::vector<RigidBody> _bodies;
+  std::vector<Material> _materials;
+  std::vector<const TriangleMesh *> _meshes;
+  std::vector<Proxy> _proxies;
+  std::vector<char> _occluders, _stale;
+};
+
+#endif // ACTOR_REGISTRY_HPP
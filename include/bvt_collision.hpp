@@ -2,9 +2,10 @@
 #define BVT_COLLISION_HPP
 
 #include <utility>
-#include <vector>
 
 #include "aabb.hpp"
+#include "cpu_profiler.hpp"
+#include "frame_arena.hpp"
 #include "DynamicTree.h"
 #include "TriangleMeshBVH.h"
 
@@ -14,16 +15,18 @@ inline bool aabbOverlap(const Aabb &box1, const Aabb &box2) {
          (box1.a.z <= box2.b.z && box1.b.z >= box2.a.z);
 }
 
+// the traversal stack is taken from arena
 template <typename Tree, typename Policy>
-inline void collideTT(const Tree &tree0, const Tree &tree1, Policy policy) {
+inline void collideTT(const Tree &tree0, const Tree &tree1, Policy policy,
+                      FrameArena &arena) {
+  PROFILE_ZONE("collideTT");
   using Node = decltype(tree0.getNode(0));
   using NodePair = std::pair<Node, Node>;
   auto root0{tree0.getNode(tree0.root())}, root1{tree1.getNode(tree1.root())};
   if (root0 && root1) {
     int depth = 1;
     int treshold = 124;
-    std::vector<NodePair> stack;
-    stack.resize(128);
+    FrameVector<NodePair> stack(128, arena);
     stack[0] = NodePair(root0, root1);
     do {
       NodePair p = stack[--depth];
@@ -32,6 +32,9 @@ public:
   void updateWorldToCamera();
   void updatePerspective();
 
+protected:
+  void _worldChanged() override;
+
 private:
   float _fov, _aspect, _near, _far;
   mat4 _perspective, _worldToCamera;
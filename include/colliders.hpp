@@ -1,7 +1,10 @@
 #ifndef COLLIDERS_HPP
 #define COLLIDERS_HPP
 
+#include <utility>
+
 #include "actor.hpp"
+#include "frame_arena.hpp"
 #include "simulation_step.hpp"
 #include "triangle_intersection.hpp"
 
@@ -11,14 +14,16 @@ struct MeshCollider {
   using Bvt = cg::TriangleMeshBVH;
   using Triangles = Bvt::PrimitiveArray;
 
+  using Contact = CollisionProps<Actor>;
+
   MeshCollider(Actor *actor1, Actor *actor2, Triangles &mesh1trigs,
-               Triangles &mesh2trigs, float dt)
+               Triangles &mesh2trigs, FrameVector<Contact> &contacts)
       : actor1{actor1}, actor2{actor2}, mesh1trigs{mesh1trigs},
-        mesh2trigs{mesh2trigs}, dt{dt} {}
+        mesh2trigs{mesh2trigs}, contacts{contacts} {}
 
   // narrow phase
   void process(int first1, int count1, int first2, int count2) {
-    auto &trs1 = actor1->transform(), &trs2 = actor2->transform();
+    auto &trs1 = actor1->worldTransform(), &trs2 = actor2->worldTransform();
     auto begin1{mesh1trigs.data() + first1}, begin2{mesh2trigs.data() + first2};
     auto end1{begin1 + count1}, end2{begin2 + count2};
     for (auto p1{begin1}; p1 < end1; ++p1) {
@@ -40,14 +45,14 @@ struct MeshCollider {
           // collision detected
 
           if (coplanar) {
-            a = actor1->_centerOfMass;
-            b = actor2->_centerOfMass;
+            a = actor1->body()._centerOfMass;
+            b = actor2->body()._centerOfMass;
           }
           auto p{0.5f * (a + b)};
           auto n{normalize(n2)};
 
-          CollisionProps<Actor> props{p, n, *actor1, *actor2};
-          simulatePhysicsStep(props, dt);
+          // resolved later, so that pairs can be tested in parallel
+          contacts.push_back({p, n, *actor1, *actor2});
         }
       }
     }
@@ -55,20 +60,18 @@ struct MeshCollider {
 
   Actor *actor1, *actor2;
   Triangles &mesh1trigs, &mesh2trigs;
-  float dt;
+  FrameVector<Contact> &contacts;
 };
 
 struct BvtCollider {
   using Bvt = cg::TriangleMeshBVH;
+  using Pair = std::pair<Bvt *, Bvt *>;
 
-  // callback for when two DBVT leaves (which are BVTs) collide
-  void process(Bvt *bvt1, Bvt *bvt2) {
-    collideTT(*bvt1, *bvt2,
-              MeshCollider{bvt1->actor(), bvt2->actor(), bvt1->primitives(),
-                           bvt2->primitives(), dt});
-  }
+  // callback for when two DBVT leaves (which are BVTs) collide; the pair is
+  // only recorded, for its narrow phase to run along with the others'
+  void process(Bvt *bvt1, Bvt *bvt2) { pairs.emplace_back(bvt1, bvt2); }
 
-  float dt;
+  FrameVector<Pair> &pairs;
 };
 
 #endif // COLLIDERS_HPP
\ No newline at end of file
@@ -1,7 +1,7 @@
 #ifndef COLLISION_PROPS_HPP
 #define COLLISION_PROPS_HPP
 
-#include "glm.hpp"
+#include "glm/glm.hpp"
 
 template <typename T> struct CollisionProps {
   glm::vec3 p, n;
@@ -0,0 +1,14 @@
+#ifndef CONVEX_HULL_HPP
+#define CONVEX_HULL_HPP
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// The vertices of the convex hull of points, found by quickhull (Barber et
+// al. 1996), in no particular order. Points within rounding distance of the
+// hull may be left out. Flat or degenerate point sets, which have no 3D hull,
+// give back every point, which is still a superset of the hull's vertices.
+std::vector<glm::vec3> convexHullVertices(const std::vector<glm::vec3> &points);
+
+#endif  // CONVEX_HULL_HPP
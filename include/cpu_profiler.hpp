@@ -0,0 +1,85 @@
+#ifndef CPU_PROFILER_HPP
+#define CPU_PROFILER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Instrumentation of CPU work. PROFILE_ZONE("name") times the rest of the
+// enclosing scope; zones nest, and every thread records its own into a buffer
+// of its own, so recording takes no locks. Buffers keep the last bufferSize
+// zones of their thread, which can be exported as a Chrome trace, to be
+// opened in chrome://tracing or Perfetto, or looked at frame by frame.
+//
+// Defining NO_CPU_PROFILER compiles every zone out.
+class CpuProfiler {
+ public:
+  static constexpr size_t bufferSize{1 << 16};
+
+  // times in nanoseconds since the profiler started
+  struct Zone {
+    const char *name;  // must outlive the profiler, a literal usually is
+    int64_t start, end;
+    uint32_t depth;  // of nesting within the zones of its thread
+  };
+
+  struct ThreadZone {
+    uint32_t thread;  // in order of first zone recorded, from 0
+    Zone zone;
+  };
+
+  static int64_t now();
+
+  // called by the zones as they end, on their own thread
+  static void record(const Zone &zone);
+
+  // zone nesting level of the calling thread
+  static uint32_t &depth();
+
+  // marks the start of a frame
+  static void markFrame();
+
+  // bounds of the last complete frame, between the last two marks
+  static int64_t frameStart();
+  static int64_t frameEnd();
+
+  // every zone of every thread still in the buffers that started within
+  // [start, end), thread by thread, in order of ending
+  static void collect(int64_t start, int64_t end,
+                      std::vector<ThreadZone> &zones);
+
+  // returns whether it succeeded
+  static bool exportChromeTrace(const std::string &fileName);
+};
+
+// times the scope it lives in
+class CpuZone {
+ public:
+  explicit CpuZone(const char *name)
+      : _name{name}, _start{CpuProfiler::now()} {
+    ++CpuProfiler::depth();
+  }
+  CpuZone(const CpuZone &other) = delete;
+  ~CpuZone() {
+    auto depth{--CpuProfiler::depth()};
+    CpuProfiler::record({_name, _start, CpuProfiler::now(), depth});
+  }
+
+  CpuZone &operator=(const CpuZone &other) = delete;
+
+ private:
+  const char *_name;
+  int64_t _start;
+};
+
+#ifdef NO_CPU_PROFILER
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#else
+#define PROFILE_CONCAT_HELPER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_HELPER(a, b)
+#define PROFILE_ZONE(name) CpuZone PROFILE_CONCAT(cpuZone, __LINE__){name}
+#define PROFILE_FRAME() CpuProfiler::markFrame()
+#endif
+
+#endif  // CPU_PROFILER_HPP
@@ -1,85 +1,59 @@
 #ifndef DBVH_HPP
 #define DBVH_HPP
 
-#include <memory>
+#include <vector>
 
-#include "scene.hpp"
+#include "actor.hpp"
 
+// A bounding volume hierarchy over actors, built bottom up by locally-ordered
+// clustering (PLOC, Meister and Bittner 2018). The actors are sorted by the
+// Morton codes of their centers, then, on every pass, each cluster looks at
+// the searchRadius clusters on either side of it for the one whose union
+// with it has the least area, and the clusters that pick each other are
+// merged. A pass is linear and roughly halves the clusters, so building is
+// O(n log n).
 class DynamicBoundingVolumeHierarchy {
 public:
+  static constexpr int null{-1};
+  // wider searches find better pairs, for a proportionally longer build
+  static constexpr int searchRadius{16};
+
   struct Node {
+    bool isLeaf() const { return left == null; }
+
     Aabb aabb;
-    std::shared_ptr<Actor> object{};
-    std::shared_ptr<Node> parent{}, left{}, right{};
-    std::string debugName;
+    Actor *object{}; // leaves only, not owned
+    int parent{null}, left{null}, right{null};
   };
 
-  using NodePtr = std::shared_ptr<Node>;
-  using VisitFun = std::function<void(NodePtr)>;
+  DynamicBoundingVolumeHierarchy(const std::vector<Actor *> &actors);
 
-  DynamicBoundingVolumeHierarchy(const Scene &scene) {
-    std::vector<NodePtr> workingList;
-    for (auto &actor : scene.actors()) {
-      auto tmpNode{std::make_shared<Node>(actor->bounds(), actor)};
-      tmpNode->debugName = actor->name();
-      workingList.push_back(tmpNode);
-    }
-    while (workingList.size() > 1) {
-      float minSqDist{FLT_MAX};
-      NodePtr n1, n2;
-      for (auto &node1 : workingList) {
-        for (auto &node2 : workingList) {
-          if (node1 == node2)
-            continue;
-          auto c1{0.5f * (node1->aabb.a + node1->aabb.b)};
-          auto c2{0.5f * (node2->aabb.a + node2->aabb.b)};
-          auto cdiff{c1 - c2};
-          auto sqDist{glm::dot(cdiff, cdiff)};
-          if (sqDist < minSqDist) {
-            minSqDist = sqDist;
-            n1 = node1;
-            n2 = node2;
-          }
-        }
-      }
-      auto newNode{
-          std::make_shared<Node>(Aabb{glm::min(n1->aabb.a, n2->aabb.a),
-                                      glm::max(n1->aabb.b, n2->aabb.b)},
-                                 nullptr, nullptr, n1, n2)};
-      newNode->debugName = "(" + n1->debugName + " + " + n2->debugName + ")";
-      n1->parent = n2->parent = newNode;
-      std::erase(workingList, n1);
-      std::erase(workingList, n2);
-      workingList.push_back(newNode);
-    }
-    if (!workingList.empty())
-      _root = workingList[0];
-  }
-
-  void visit(VisitFun f) { _visit(_root, f); }
+  // leaves come first, in the order of the actors, and the root last
+  const std::vector<Node> &nodes() const { return _nodes; }
+  int root() const { return _root; }
 
-  void debugPrint() {
-    visit([](NodePtr node) {
-      printf("[(%f %f %f), (%f %f %f)]", node->aabb.a.x, node->aabb.a.y,
-             node->aabb.a.z, node->aabb.b.x, node->aabb.b.y, node->aabb.b.z);
-      if (node->object)
-        printf("%s", node->object->name().c_str());
-      puts("");
-    });
+  // calls f(index, node) for every node, children before their parents
+  template <class F> void visit(F f) const {
+    if (_root != null)
+      _visit(_root, f);
   }
 
+  void debugPrint() const;
+
 private:
-  void _visit(NodePtr node, VisitFun f) {
-    if (node) {
-      _visit(node->left, f);
-      _visit(node->right, f);
-      f(node);
+  template <class F> void _visit(int index, F &f) const {
+    auto &node{_nodes[index]};
+    if (!node.isLeaf()) {
+      _visit(node.left, f);
+      _visit(node.right, f);
     }
+    f(index, node);
   }
 
-  std::shared_ptr<Node> _root{};
+  std::vector<Node> _nodes;
+  int _root{null};
 };
 
 using DBVH = DynamicBoundingVolumeHierarchy;
 
-#endif // DBVH_HPP
\ No newline at end of file
+#endif // DBVH_HPP
@@ -1,53 +1,138 @@
 #ifndef DBVT_BROADPHASE_HPP
 #define DBVT_BROADPHASE_HPP
 
+#include <vector>
+
+#include "actor.hpp"
 #include "bvt_collision.hpp"
 #include "colliders.hpp"
-#include "scene.hpp"
+#include "frame_arena.hpp"
+#include "job_system.hpp"
+#include "object_pool.hpp"
 
 #include "DynamicTree.h"
 
+// A DBVT over the actors, whose leaves are the BVTs of their meshes. A step,
+// collide(), is split in stages, so that they can be timed on their own.
+// What a step finds (pairs, contacts, traversal stacks) is kept in an arena
+// rewound at the start of the next one, so that steps don't allocate.
 struct DbvtBroadphase {
   using Bvt = cg::TriangleMeshBVH;
   using Triangles = Bvt::PrimitiveArray;
+  using Pairs = FrameVector<BvtCollider::Pair>;
+  using Contacts = FrameVector<MeshCollider::Contact>;
 
-  DbvtBroadphase(Scene &scene) : scene{scene}, indices(scene.actors().size()) {
+  DbvtBroadphase(const std::vector<Actor *> &actors) : actors{actors} {
     // populating the DBVT
-    int i{};
-    for (auto &actor : scene.actors()) {
-      auto &verts{actor->mesh->vertices()};
+    auto &registry{ActorRegistry::instance()};
+    for (auto &actor : actors) {
+      auto &proxy{registry.proxies()[actor->slot()]};
+      ASSERT(!proxy.broadphase, "%s is already in a broadphase\n",
+             actor->name().c_str());
+      auto &verts{actor->mesh()->vertices()};
       Triangles triangles;
-      for (auto &idxt : actor->mesh->triangles())
+      for (auto &idxt : actor->mesh()->triangles())
         triangles.push_back({verts[idxt.v1], verts[idxt.v2], verts[idxt.v3]});
-      auto bvt{new Bvt{actor, std::move(triangles)}}; // FIXME: memory leak
-      indices[i++] = tree.add(bvt->bounds(), bvt);
+      proxy = {this, tree.add(actor->bounds(),
+                              bvts.create(actor, std::move(triangles)))};
+      handles.push_back(actor->handle());
     }
   }
+  DbvtBroadphase(const DbvtBroadphase &other) = delete;
+  ~DbvtBroadphase() {
+    auto &registry{ActorRegistry::instance()};
+    for (auto handle : handles)
+      if (registry.valid(handle))
+        registry.proxies()[registry.slot(handle)] = {nullptr, -1};
+  }
 
-  void collide() {
-    collideTT(tree, tree, BvtCollider{scene.timeStep()});
-    int i{};
-    // TODO: make broadphase scene-independent
-    for (auto &actor : scene.actors()) {
-      // TODO: find a way to move this physics stuff into simulatePhysicsStep()
-      static constexpr vec3 gravity{0, -0.0005, 0};
-      if (actor->_inverseMass > 0)
-        actor->_velocity += gravity * scene.timeStep();
-      actor->translate(actor->_velocity);
-      actor->rotate(actor->_angularVelocity);
+  DbvtBroadphase &operator=(const DbvtBroadphase &other) = delete;
 
-      // TODO: not refit every frame
-      tree.remove(indices[i]);
+  void collide(float timeStep) {
+    PROFILE_ZONE("DbvtBroadphase::collide");
+    findPairs();
+    narrowPhase();
+    resolve(timeStep);
+    integrate(timeStep);
+  }
+
+  // pairs of actors whose bounds overlap
+  void findPairs() {
+    // the last step's lists are in the arena, so they go before it's rewound
+    contacts = FrameVector<Contacts>{arena};
+    pairs = Pairs{arena};
+    arena.reset();
+    collideTT(tree, tree, BvtCollider{pairs}, arena);
+  }
+
+  // pairs are tested in parallel, each into its own contacts
+  void narrowPhase() {
+    // transforms are read from several threads, so none can be left to
+    // compose on first use
+    ActorRegistry::instance().syncTransforms();
+    contacts.clear();
+    contacts.reserve(pairs.size());
+    for (size_t i = 0; i < pairs.size(); ++i) contacts.emplace_back(arena);
+    JobSystem::instance().parallelFor(
+        0, pairs.size(), 1, [this](size_t first, size_t last) {
+          for (auto i = first; i < last; ++i) {
+            auto [bvt1, bvt2]{pairs[i]};
+            collideTT(*bvt1, *bvt2,
+                      MeshCollider{bvt1->actor(), bvt2->actor(),
+                                   bvt1->primitives(), bvt2->primitives(),
+                                   contacts[i]},
+                      arena);
+          }
+        });
+  }
 
-      // FIXME: this does not work, actors are no longer the leaves, BVTs are
-      // use tree bounds instead (which means the tree needs its own transform?)
-      indices[i++] = tree.add(actor->bounds(), actor);
+  // in order, as bodies are shared between pairs
+  void resolve(float timeStep) {
+    for (size_t i = 0; i < pairs.size(); ++i)
+      for (auto &contact : contacts[i]) simulatePhysicsStep(contact, timeStep);
+  }
+
+  void integrate(float timeStep) {
+    move(timeStep);
+    refit();
+  }
+
+  // walks the registry's arrays in slot order, skipping the actors of other
+  // broadphases; only moving the actors goes through them
+  void move(float timeStep) {
+    auto &registry{ActorRegistry::instance()};
+    auto bodies{registry.bodies()};
+    auto proxies{registry.proxies()};
+    auto owners{registry.actors()};
+    for (size_t i = 0; i < bodies.size(); ++i) {
+      if (proxies[i].broadphase != this) continue;
+      auto &body{bodies[i]};
+      // TODO: find a way to move this physics stuff into simulatePhysicsStep()
+      static constexpr vec3 gravity{0, -0.0005, 0};
+      if (body._inverseMass > 0) body._velocity += gravity * timeStep;
+      owners[i]->advance(i, body._velocity, body._angularVelocity);
     }
   }
 
-  Scene &scene;
+  // TODO: not refit every frame
+  // the BVTs themselves stay in mesh space, where MeshCollider transforms
+  // their triangles from
+  void refit() {
+    auto &registry{ActorRegistry::instance()};
+    auto bounds{registry.bounds()};
+    auto proxies{registry.proxies()};
+    for (size_t i = 0; i < bounds.size(); ++i)
+      if (proxies[i].broadphase == this)
+        tree.update(proxies[i].leaf, bounds[i]);
+  }
+
+  std::vector<Actor *> actors;
+  ObjectPool<Bvt> bvts;
+  std::vector<ActorRegistry::Handle> handles;  // of the actors
   cg::DynamicTree tree;
-  std::vector<int> indices;
+  FrameArena arena{1 << 20};
+  Pairs pairs{arena};
+  FrameVector<Contacts> contacts{arena};  // per pair
 };
 
-#endif // DBVT_BROADPHASE_HPP
\ No newline at end of file
+#endif  // DBVT_BROADPHASE_HPP
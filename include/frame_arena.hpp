@@ -0,0 +1,75 @@
+#ifndef FRAME_ARENA_HPP
+#define FRAME_ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+// A linear allocator for what lives no longer than a frame or a physics step:
+// allocating bumps an offset, nothing is freed by itself, and reset() rewinds
+// the whole arena at once. What doesn't fit is taken from the heap, in blocks
+// of its own that reset() frees, growing the arena to hold it all next time,
+// so that once frames settle they don't allocate at all.
+//
+// Allocating is thread-safe. Resetting isn't, and invalidates whatever was
+// allocated, which is never destroyed either.
+class FrameArena {
+ public:
+  explicit FrameArena(size_t capacity = 64 * 1024);
+  FrameArena(const FrameArena &other) = delete;
+
+  FrameArena &operator=(const FrameArena &other) = delete;
+
+  // alignment must be a power of two
+  void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  void reset();
+
+  size_t capacity() const;
+  // bytes allocated since the last reset, padding and overflow included
+  size_t used() const;
+
+ private:
+  void *_allocateOverflow(size_t size, size_t alignment);
+
+  std::unique_ptr<std::byte[]> _memory;
+  size_t _capacity;
+  std::atomic<size_t> _offset{};
+
+  std::mutex _overflowMutex;
+  std::vector<std::unique_ptr<std::byte[]>> _overflow;
+  std::atomic<size_t> _overflowSize{};
+};
+
+// lets standard containers allocate from an arena; they never free, the
+// arena being reset instead, so they mustn't outlive the reset either
+template <class T>
+struct FrameAllocator {
+  using value_type = T;
+  // assigning a container takes the other's storage, whatever its arena
+  using propagate_on_container_move_assignment = std::true_type;
+
+  FrameAllocator(FrameArena &arena) : arena{&arena} {}
+  template <class U>
+  FrameAllocator(const FrameAllocator<U> &other) : arena{other.arena} {}
+
+  T *allocate(size_t count) {
+    return static_cast<T *>(arena->allocate(count * sizeof(T), alignof(T)));
+  }
+  void deallocate(T *, size_t) {}
+
+  template <class U>
+  bool operator==(const FrameAllocator<U> &other) const {
+    return arena == other.arena;
+  }
+
+  FrameArena *arena;
+};
+
+template <class T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#endif  // FRAME_ARENA_HPP
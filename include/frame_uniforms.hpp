@@ -0,0 +1,41 @@
+#ifndef FRAME_UNIFORMS_HPP
+#define FRAME_UNIFORMS_HPP
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+using namespace glm;
+
+// everything the programs read once per frame, laid out as the std140 Frame
+// block of shader_sources.hpp; shared by every program and every variant of
+// them, so that switching between them needs no uniforms set
+struct FrameUniforms {
+  mat4 V, P, invP;
+  vec4 ambient;
+  // see LightClusters::setUniforms
+  vec2 clusterTan, clusterDepth;
+  uvec3 clusterCount;
+  // section of the instance ring uploaded this frame
+  GLuint firstObject;
+};
+
+static_assert(sizeof(FrameUniforms) == 240,
+              "FrameUniforms must match the std140 Frame block");
+
+// Holds the frame uniforms on the GPU, at uniform buffer binding 0.
+class FrameUniformBuffer {
+ public:
+  FrameUniformBuffer();
+  FrameUniformBuffer(const FrameUniformBuffer &other) = delete;
+  ~FrameUniformBuffer();
+
+  FrameUniformBuffer &operator=(const FrameUniformBuffer &other) = delete;
+
+  // uploads the uniforms and binds the buffer
+  void update(const FrameUniforms &uniforms);
+
+ private:
+  GLuint _buffer{};
+};
+
+#endif  // FRAME_UNIFORMS_HPP
@@ -0,0 +1,49 @@
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include "aabb.hpp"
+#include "glm/glm.hpp"
+
+// The six planes bounding what a camera sees, each stored as (n, d) with
+// dot(n, x) + d >= 0 for points x on the inside
+struct Frustum {
+  enum class Containment { outside, intersecting, inside };
+
+  // extracts the planes from a clip-from-world matrix, i.e. P * V, following
+  // Gribb and Hartmann
+  static Frustum fromMatrix(const glm::mat4 &m) {
+    auto row{[&m](int i) {
+      return glm::vec4{m[0][i], m[1][i], m[2][i], m[3][i]};
+    }};
+    auto r0{row(0)}, r1{row(1)}, r2{row(2)}, r3{row(3)};
+
+    Frustum f;
+    f.planes[0] = r3 + r0;  // left
+    f.planes[1] = r3 - r0;  // right
+    f.planes[2] = r3 + r1;  // bottom
+    f.planes[3] = r3 - r1;  // top
+    f.planes[4] = r3 + r2;  // near
+    f.planes[5] = r3 - r2;  // far
+    for (auto &plane : f.planes) plane /= glm::length(glm::vec3{plane});
+    return f;
+  }
+
+  // tests, for each plane, the box corner furthest along the plane's normal
+  // and the one furthest against it
+  Containment classify(const Aabb &box) const {
+    auto result{Containment::inside};
+    for (auto &plane : planes) {
+      glm::vec3 n{plane};
+      auto furthest{glm::mix(box.a, box.b, glm::greaterThan(n, glm::vec3{}))};
+      auto nearest{glm::mix(box.b, box.a, glm::greaterThan(n, glm::vec3{}))};
+      if (glm::dot(n, furthest) + plane.w < 0) return Containment::outside;
+      if (glm::dot(n, nearest) + plane.w < 0)
+        result = Containment::intersecting;
+    }
+    return result;
+  }
+
+  glm::vec4 planes[6];
+};
+
+#endif  // FRUSTUM_HPP
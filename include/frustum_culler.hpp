@@ -0,0 +1,41 @@
+#ifndef FRUSTUM_CULLER_HPP
+#define FRUSTUM_CULLER_HPP
+
+#include <unordered_map>
+#include <vector>
+
+#include "DynamicTree.h"
+#include "actor.hpp"
+#include "frustum.hpp"
+
+// Keeps the world AABBs of the scene's actors in a dynamic tree and finds the
+// ones inside a view frustum. Subtrees entirely inside or outside the frustum
+// are accepted or rejected as a whole, without visiting their leaves' boxes.
+class FrustumCuller {
+ public:
+  void add(Actor *actor);
+  void remove(const Actor *actor);
+
+  // moves the leaves of actors whose bounds left their fattened boxes; actors
+  // moving only slightly don't touch the tree
+  void refit();
+
+  // replaces visible with the actors overlapping the frustum
+  void cull(const Frustum &frustum, std::vector<const Actor *> &visible) const;
+
+  size_t actorCount() const;
+
+ private:
+  // how much leaf boxes are inflated, relative to their size, so that small
+  // motions don't require moving leaves around
+  static constexpr float _margin{0.1f};
+
+  static Aabb _fatten(const Aabb &bounds);
+  static void _collect(const cg::DynamicTree &tree, int index,
+                       std::vector<const Actor *> &visible);
+
+  cg::DynamicTree _tree;
+  std::unordered_map<const Actor *, int> _leaves;
+};
+
+#endif  // FRUSTUM_CULLER_HPP
@@ -0,0 +1,41 @@
+#ifndef G_BUFFER_HPP
+#define G_BUFFER_HPP
+
+#include "glad/glad.h"
+
+// Render targets of the deferred path's geometry pass: what the lighting pass
+// needs to know of the nearest surface under every pixel. Lighting then costs
+// one shading per pixel, however many times the pixel was drawn over.
+class GBuffer {
+ public:
+  // color attachments, in order; see triangleMeshGBufferFragShader
+  enum Target { normal, albedo, specular, ambient, targetCount };
+
+  GBuffer();
+  GBuffer(const GBuffer &other) = delete;
+  ~GBuffer();
+
+  GBuffer &operator=(const GBuffer &other) = delete;
+
+  // reallocates the targets when the size changed
+  void resize(GLsizei width, GLsizei height);
+
+  // binds the framebuffer for drawing
+  void bind() const;
+
+  // binds the targets to consecutive texture units in Target order, depth
+  // coming last
+  void bindTextures(GLuint firstUnit) const;
+
+  // copies the depth into the target framebuffer, so that forward passes
+  // drawn over the lit scene are still hidden by it; the target must be
+  // single-sampled with the same depth format, as an OffscreenTarget is.
+  // Leaves the target bound
+  void blitDepth(GLuint target) const;
+
+ private:
+  GLuint _framebuffer{}, _targets[targetCount]{}, _depth{};
+  GLsizei _width{}, _height{};
+};
+
+#endif  // G_BUFFER_HPP
@@ -0,0 +1,81 @@
+#ifndef GPU_PROFILER_HPP
+#define GPU_PROFILER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+
+// Times the passes of a frame on the GPU with GL_TIME_ELAPSED queries. Every
+// frame in flight has its own pool of queries, read latency frames later,
+// once the GPU is surely done with them, so profiling never stalls the
+// pipeline. The last historySize frames of every pass are kept for averages
+// and percentiles.
+//
+// Passes are told apart by name and may not nest, nor overlap any other
+// GL_TIME_ELAPSED query; a pass begun several times in a frame adds up.
+class GpuProfiler {
+ public:
+  static constexpr unsigned latency{3}, historySize{240};
+
+  // milliseconds over the frames kept
+  struct Stats {
+    double average, p50, p95, p99;
+  };
+
+  GpuProfiler() = default;
+  GpuProfiler(const GpuProfiler &other) = delete;
+  ~GpuProfiler();
+
+  GpuProfiler &operator=(const GpuProfiler &other) = delete;
+
+  // collects the results of the frame issued latency frames ago
+  void beginFrame();
+  void endFrame();
+
+  // collects the results of every frame still in flight, waiting for the
+  // GPU to be done with them; for between frames, before exporting the last
+  // of them
+  void flush();
+
+  void begin(const char *pass);
+  void end();
+
+  // every pass timed so far, in the order they first appeared
+  size_t passCount() const;
+  const std::string &passName(size_t pass) const;
+  Stats stats(size_t pass) const;
+
+  // one frame,pass,ms row per pass of every frame kept, oldest first;
+  // returns whether it succeeded
+  bool exportCsv(const std::string &fileName) const;
+
+ private:
+  struct Pass {
+    std::string name;
+    // rings of the last historySize frames the pass ran in
+    std::vector<uint64_t> frames;
+    std::vector<double> ms;
+    size_t next{};
+  };
+
+  // queries issued in a frame, and the pass each one timed
+  struct Frame {
+    uint64_t index{};
+    std::vector<GLuint> queries;
+    std::vector<size_t> passes;
+    size_t used{};
+  };
+
+  // records the times of the frame's passes, leaving it empty
+  void _collect(Frame &frame);
+
+  std::vector<Pass> _passes;
+  Frame _frames[latency]{};
+  unsigned _current{};
+  uint64_t _frameIndex{};
+  std::vector<double> _frameMs;  // per pass, reused while collecting
+};
+
+#endif  // GPU_PROFILER_HPP
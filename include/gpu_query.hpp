@@ -0,0 +1,36 @@
+#ifndef GPU_QUERY_HPP
+#define GPU_QUERY_HPP
+
+#include "glad/glad.h"
+
+// Measures the GPU work issued between begin() and end(): how long it took
+// with GL_TIME_ELAPSED, or how many fragments it shaded with
+// GL_FRAGMENT_SHADER_INVOCATIONS, for instance. Results are read a few frames
+// late, once the GPU is surely done with them, so measuring never stalls the
+// pipeline; they are averaged over recent frames to be readable on screen.
+// Queries of different targets may overlap, queries of the same one may not.
+class GpuQuery {
+ public:
+  static constexpr unsigned latency{3};
+
+  explicit GpuQuery(GLenum target);
+  GpuQuery(const GpuQuery &other) = delete;
+  ~GpuQuery();
+
+  GpuQuery &operator=(const GpuQuery &other) = delete;
+
+  void begin();
+  void end();
+
+  // average result, nanoseconds for timers; 0 until the first one is back
+  double average() const;
+
+ private:
+  GLenum _target;
+  GLuint _queries[latency]{};
+  bool _pending[latency]{};
+  unsigned _current{};
+  double _average{};
+};
+
+#endif  // GPU_QUERY_HPP
@@ -0,0 +1,63 @@
+#ifndef GPU_RESOURCES_HPP
+#define GPU_RESOURCES_HPP
+
+#include <string>
+#include <unordered_map>
+
+#include "actor.hpp"
+#include "glad/glad.h"
+#include "mesh_arena.hpp"
+
+// Keeps a single GPU copy of every mesh and texture used by the scene's
+// actors, meshes being packed into a shared MeshArena. Copies are reference
+// counted, so making an actor resident only
+// uploads what no other actor uses yet, and releasing it only frees what no
+// other actor still needs.
+class GpuResources {
+ public:
+  using Mesh = MeshArena::Allocation;
+
+  GpuResources() = default;
+  GpuResources(const GpuResources &other) = delete;
+  ~GpuResources();
+
+  GpuResources &operator=(const GpuResources &other) = delete;
+
+  void acquire(const Actor *actor);
+  void release(const Actor *actor);
+
+  const Mesh &mesh(const TriangleMesh *mesh) const;
+  GLuint texture(const std::string &file) const;
+
+  const MeshArena &arena() const;
+
+  size_t meshCount() const;
+  size_t textureCount() const;
+
+ private:
+  struct MeshEntry {
+    Mesh allocation;
+    size_t references;
+  };
+
+  struct TextureEntry {
+    GLuint texture;
+    size_t references;
+  };
+
+  // what each actor was given, so it can be released even if its material
+  // changed in the meantime
+  struct Residency {
+    const TriangleMesh *mesh;
+    std::string texture;
+  };
+
+  static void upload(GLuint texture, const std::string &file);
+
+  MeshArena _arena;
+  std::unordered_map<const TriangleMesh *, MeshEntry> _meshes;
+  std::unordered_map<std::string, TextureEntry> _textures;
+  std::unordered_map<const Actor *, Residency> _residents;
+};
+
+#endif  // GPU_RESOURCES_HPP
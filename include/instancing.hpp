@@ -0,0 +1,65 @@
+#ifndef INSTANCING_HPP
+#define INSTANCING_HPP
+
+#include <string>
+#include <vector>
+
+#include "actor.hpp"
+#include "glad/glad.h"
+#include "render_queue.hpp"
+#include "stream_ring.hpp"
+
+// per-instance data, laid out as the std430 ObjectData of
+// triangleMeshVertexShader
+struct InstanceData {
+  mat4 M;
+  vec4 KaNs;  // ambient color and shininess
+  vec4 KdNi;  // diffuse color and index of refraction
+  vec4 KsD;   // specular color and dissolve
+};
+
+// Streams the per-instance data of a sorted render queue, turning runs of
+// items that share a state, and so a mesh and a texture, into batches that
+// can each be drawn with a single instanced call. Batches follow the order of
+// the queue.
+class InstanceBatcher {
+ public:
+  struct Batch {
+    RenderQueue::Pass pass;
+    const TriangleMesh *mesh;
+    // the first actor's texture file, left in its material rather than
+    // copied every frame; empty if untextured
+    const std::string *texture;
+    // where the batch's instances were uploaded in the last frame
+    GLuint firstInstance, instanceCount;
+  };
+
+  InstanceBatcher() = default;
+  InstanceBatcher(const InstanceBatcher &other) = delete;
+
+  InstanceBatcher &operator=(const InstanceBatcher &other) = delete;
+
+  // writes the current transform and material of the queued actors, in
+  // queue order, into the next section of the instance ring
+  void upload(const RenderQueue &queue);
+
+  // binds the instance ring to SSBO binding 1
+  void bind() const;
+
+  // where the section just uploaded starts, the firstObject of FrameUniforms
+  GLuint firstObject() const;
+
+  // fences the section just uploaded; must be called once its draws are
+  // issued
+  void endFrame();
+
+  size_t bytesStreamed() const;
+
+  const std::vector<Batch> &batches() const;
+
+ private:
+  std::vector<Batch> _batches;
+  StreamRing _ring{sizeof(InstanceData)};
+};
+
+#endif  // INSTANCING_HPP
@@ -0,0 +1,155 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Runs jobs on a pool of worker threads, one per hardware thread besides the
+// one that created the system, which runs jobs too whenever it waits on one.
+// Every thread has a Chase-Lev deque of its own: it pushes and pops jobs at
+// one end, newest first, while idle threads steal from the other, oldest
+// first, which tends to hand thieves the largest pieces of work.
+//
+// A job finishes once it and every child created under it have run. Jobs may
+// also depend on others, being held back until those finish. Waiting on a job
+// runs other jobs meanwhile, so jobs may wait on jobs themselves.
+//
+// Only the threads of the system may create, run or wait on jobs. Jobs live in
+// a ring per thread, their slots being reused some time after they finish, so
+// a job is not to be touched once it is known to have finished.
+class JobSystem {
+ public:
+  static constexpr size_t jobsPerThread{4096}, dequeSize{4096};
+  static constexpr size_t maxDependents{4}, payloadSize{64};
+
+  struct alignas(64) Job {
+    void (*function)(Job &job);
+    Job *parent;
+    std::atomic<int32_t> unfinished;  // itself and its children
+    // unfinished dependencies, plus one until the job is run
+    std::atomic<int32_t> blockers;
+    uint32_t dependentCount;
+    Job *dependents[maxDependents];
+    alignas(std::max_align_t) unsigned char payload[payloadSize];
+  };
+
+  // jobs run by every thread so far, and how many of those were stolen
+  struct Stats {
+    uint64_t executed, stolen;
+  };
+
+  static JobSystem &instance();
+
+  explicit JobSystem(unsigned workerCount = defaultWorkerCount());
+  JobSystem(const JobSystem &other) = delete;
+  ~JobSystem();
+
+  JobSystem &operator=(const JobSystem &other) = delete;
+
+  static unsigned defaultWorkerCount();
+
+  // workers plus the thread that created the system
+  unsigned threadCount() const;
+
+  Stats stats() const;
+
+  // a job that calls f(), to be run later; parent, if given, won't finish
+  // before it does, and must not have finished already
+  template <class F>
+  Job *create(F &&f, Job *parent = nullptr) {
+    using Function = std::decay_t<F>;
+    static_assert(sizeof(Function) <= payloadSize,
+                  "job functions must fit in the payload");
+    static_assert(alignof(Function) <= alignof(std::max_align_t));
+
+    auto job{_allocate()};
+    job->function = [](Job &job) {
+      auto function{std::launder(reinterpret_cast<Function *>(job.payload))};
+      (*function)();
+      function->~Function();
+    };
+    job->parent = parent;
+    job->unfinished.store(1, std::memory_order_relaxed);
+    job->blockers.store(1, std::memory_order_relaxed);
+    job->dependentCount = 0;
+    if (parent) parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+    new (job->payload) Function(std::forward<F>(f));
+    return job;
+  }
+
+  // holds job back until prerequisite finishes; neither may have been run
+  void addDependency(Job *job, Job *prerequisite);
+
+  // queues job on the calling thread, unless it still has dependencies to
+  // wait for, in which case the last of them to finish queues it
+  void run(Job *job);
+
+  // runs other jobs until job finishes
+  void wait(const Job *job);
+
+  // calls f(begin, end) over consecutive subranges of [first, last) spanning
+  // grain indices at most, in parallel, and returns once every call has
+  template <class F>
+  void parallelFor(size_t first, size_t last, size_t grain, const F &f) {
+    if (grain == 0) grain = 1;
+    if (last <= first) return;
+    if (last - first <= grain) return f(first, last);
+
+    auto root{create([] {})};
+    run(create(Split<F>{this, &f, first, last, grain, root}, root));
+    run(root);
+    wait(root);
+  }
+
+ private:
+  class Deque;
+  struct Worker;
+
+  // halves its range until it is small enough, queuing the upper halves as
+  // jobs of their own, and calls f over what is left
+  template <class F>
+  struct Split {
+    JobSystem *system;
+    const F *f;
+    size_t first, last, grain;
+    Job *root;
+
+    void operator()() {
+      while (last - first > grain) {
+        auto middle{first + (last - first) / 2};
+        system->run(
+            system->create(Split{system, f, middle, last, grain, root}, root));
+        last = middle;
+      }
+      (*f)(first, last);
+    }
+  };
+
+  // the worker of the calling thread, if it has one
+  static thread_local Worker *_current;
+
+  Worker &_local();
+  Job *_allocate();
+  void _push(Job *job);
+  Job *_find(Worker &worker);
+  void _execute(Worker &worker, Job *job);
+  void _finish(Job *job);
+  void _work(unsigned index);
+
+  std::vector<std::unique_ptr<Worker>> _workers;  // the creator's first
+  std::vector<std::thread> _threads;
+
+  // bumped whenever jobs are queued while some thread sleeps, to wake it
+  std::atomic<uint32_t> _epoch{};
+  std::atomic<uint32_t> _sleeping{};
+  std::atomic<bool> _stop{};
+};
+
+#endif  // JOB_SYSTEM_HPP
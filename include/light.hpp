@@ -13,9 +13,16 @@ struct Light : public TransformableObject {
   Light &operator=(const Light &other);
   Light &operator=(Light &&other) noexcept;
 
+  // distance at which the light's contribution, falling off with the square
+  // of the distance, drops below cutoff; it is ignored past that
+  float range() const;
+
   vec3 color;
   float intensity;
 
+  // contribution below which lights are ignored, shared by every light
+  static inline float cutoff{1.0f / 256};
+
 private:
   static inline size_t _instances{};
 };
@@ -0,0 +1,66 @@
+#ifndef LIGHT_CLUSTERS_HPP
+#define LIGHT_CLUSTERS_HPP
+
+#include <vector>
+
+#include "aabb.hpp"
+#include "camera.hpp"
+#include "frame_uniforms.hpp"
+#include "glad/glad.h"
+#include "light.hpp"
+
+// light as laid out in the std430 Lights buffer of the fragment shaders
+struct ClusterLight {
+  vec4 positionRange;  // view-space position and Light::range
+  vec4 color;          // color times intensity
+};
+
+// Clustered light culling. The view frustum is split into a grid of froxels,
+// evenly in screen space and exponentially in depth, and every froxel is
+// given the list of lights whose range reaches it. Fragments then only shade
+// with the lights of the froxel they fall in, so their cost depends on the
+// lights nearby rather than on every light in the scene.
+//
+// Lights, per-froxel (offset, count) pairs and the light index lists go to
+// SSBO bindings 2, 3 and 4.
+class LightClusters {
+ public:
+  static constexpr unsigned countX{16}, countY{9}, countZ{24};
+
+  LightClusters();
+  LightClusters(const LightClusters &other) = delete;
+  ~LightClusters();
+
+  LightClusters &operator=(const LightClusters &other) = delete;
+
+  // assigns the lights to the froxels of the camera, one depth slice per
+  // task, and uploads the result
+  void build(const std::vector<Light *> &lights, const Camera &camera);
+
+  // binds the buffers
+  void bind() const;
+
+  // fills in the frame uniforms froxels are found with in the shaders:
+  // clusterCount, clusterTan and clusterDepth
+  void setUniforms(FrameUniforms &uniforms) const;
+
+  unsigned maxLightsPerCluster() const;
+
+ private:
+  void _updateBounds();
+  float _sliceDepth(unsigned slice) const;
+
+  // camera parameters the froxel bounds were built for
+  float _tanX{}, _tanY{}, _near{}, _far{};
+  std::vector<Aabb> _bounds;  // view space
+
+  std::vector<ClusterLight> _lights;
+  std::vector<std::vector<GLuint>> _lists;  // per froxel, reused
+  std::vector<uvec2> _clusters;  // offsets and counts into _indices
+  std::vector<GLuint> _indices;
+  unsigned _maxLightsPerCluster{};
+
+  GLuint _lightBuffer{}, _clusterBuffer{}, _indexBuffer{};
+};
+
+#endif  // LIGHT_CLUSTERS_HPP
@@ -1,18 +1,82 @@
 #ifndef LOG_HPP
 #define LOG_HPP
 
-#include <cstdarg>
-#include <string>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 
-inline std::string globalLog;
+// The engine's log. Records are formatted by whoever logs them, which may be
+// any thread, and handed over through a bounded lock-free ring to a writer
+// thread that prints them and keeps the last historySize of them for the UI.
+// A full ring drops what doesn't fit rather than make the caller wait.
+//
+// Errors are printed right away by the caller as well, since whatever logs
+// them may well terminate before the writer gets to them.
+class Log {
+ public:
+  static constexpr size_t ringSize{4096}, historySize{4096}, textSize{256};
 
-inline void logMsg(const char *fmt, ...) {
-  char str[1024];
-  va_list argList;
-  va_start(argList, fmt);
-  vsprintf_s(str, fmt, argList);
-  fputs(str, stdout);
-  globalLog += str;
-}
+  enum class Severity : uint8_t { info, warning, error };
 
-#endif // LOG_HPP
\ No newline at end of file
+  struct Record {
+    Severity severity;
+    bool printed;  // already, by the caller
+    char text[textSize];
+  };
+
+  static Log &instance();
+
+  Log();
+  Log(const Log &other) = delete;
+  ~Log();
+
+  Log &operator=(const Log &other) = delete;
+
+  // returns false, and drops the record, if the ring is full
+  bool push(const Record &record);
+
+  // records dropped so far
+  uint64_t dropped() const;
+
+  // calls f with the records kept, oldest first, which won't change meanwhile
+  template <class F>
+  void read(F f) const {
+    std::lock_guard lock{_historyMutex};
+    f(const_cast<const std::deque<Record> &>(_history));
+  }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> sequence;
+    Record record;
+  };
+
+  void _write();
+  bool _pop(Record &record);
+
+  // producers claim positions from _tail, the writer alone advances _head;
+  // a slot's sequence tells whose turn it is to touch it
+  std::unique_ptr<Slot[]> _slots{new Slot[ringSize]};
+  alignas(64) std::atomic<uint64_t> _tail{};
+  alignas(64) uint64_t _head{};
+  std::atomic<uint64_t> _dropped{};
+
+  // bumped on every push, for the writer to sleep on
+  std::atomic<uint32_t> _pushed{};
+  std::atomic<bool> _stop{};
+
+  mutable std::mutex _historyMutex;
+  std::deque<Record> _history;
+
+  std::thread _writer;
+};
+
+// printf-like; the severity is taken from the tag the message starts with,
+// [INFO], [WARNING] or [ERROR], and is info for untagged messages
+void logMsg(const char *fmt, ...);
+
+#endif  // LOG_HPP
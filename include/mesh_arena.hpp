@@ -0,0 +1,73 @@
+#ifndef MESH_ARENA_HPP
+#define MESH_ARENA_HPP
+
+#include <map>
+
+#include "glad/glad.h"
+#include "triangle_mesh.hpp"
+
+// interleaved vertex layout of the arena, attributes 0 through 2 of
+// triangleMeshVertexShader
+struct ArenaVertex {
+  vec3 p, n;
+  vec2 uv;
+};
+
+// Hands out ranges of a linear store of a given capacity, first fit.
+// Freed ranges are merged with their free neighbors so that the store does
+// not fragment into unusable slivers.
+class RangeAllocator {
+ public:
+  static constexpr size_t invalid{~size_t{}};
+
+  explicit RangeAllocator(size_t capacity = 0);
+
+  // offset of the range, or invalid if no free range is large enough
+  size_t allocate(size_t size);
+  void free(size_t offset, size_t size);
+
+  // the new space is appended to the free range at the end, if any
+  void grow(size_t capacity);
+
+  size_t capacity() const;
+  size_t used() const;
+
+ private:
+  std::map<size_t, size_t> _free;  // offset to size
+  size_t _capacity, _used{};
+};
+
+// A single interleaved vertex buffer and a single index buffer holding the
+// geometry of every resident mesh, so that all of them can be drawn without
+// rebinding anything. Both grow by doubling when an allocation does not fit.
+class MeshArena {
+ public:
+  struct Allocation {
+    GLint baseVertex;
+    GLuint firstIndex, indexCount, vertexCount;
+  };
+
+  MeshArena();
+  MeshArena(const MeshArena &other) = delete;
+  ~MeshArena();
+
+  MeshArena &operator=(const MeshArena &other) = delete;
+
+  Allocation allocate(const TriangleMesh *mesh);
+  void free(const Allocation &allocation);
+
+  // points attributes 0 through 2 and the element array of the bound VAO at
+  // the arena; must be called again after an allocation made the arena grow
+  void bind() const;
+
+  size_t vertexCount() const;
+  size_t indexCount() const;
+
+ private:
+  static void _grow(GLuint &buffer, size_t oldBytes, size_t newBytes);
+
+  GLuint _vertices{}, _indices{};
+  RangeAllocator _vertexRanges, _indexRanges;
+};
+
+#endif  // MESH_ARENA_HPP
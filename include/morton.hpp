@@ -0,0 +1,42 @@
+#ifndef MORTON_HPP
+#define MORTON_HPP
+
+#include <cstdint>
+
+#include "aabb.hpp"
+#include "glm/glm.hpp"
+
+// 21 bits per axis, so three interleaved axes fit in a 63-bit code
+constexpr unsigned mortonBitsPerAxis{21};
+
+// spreads the lower 21 bits of x so that there are two zero bits between each
+// of them
+inline uint64_t mortonSpreadBits(uint64_t x) {
+  x &= 0x1fffff;
+  x = (x | x << 32) & 0x1f00000000ffff;
+  x = (x | x << 16) & 0x1f0000ff0000ff;
+  x = (x | x << 8) & 0x100f00f00f00f00f;
+  x = (x | x << 4) & 0x10c30c30c30c30c3;
+  x = (x | x << 2) & 0x1249249249249249;
+  return x;
+}
+
+inline uint64_t mortonEncode(uint32_t x, uint32_t y, uint32_t z) {
+  return mortonSpreadBits(x) | mortonSpreadBits(y) << 1 |
+         mortonSpreadBits(z) << 2;
+}
+
+// encodes p after mapping the box [lo, lo + extent] onto the 21-bit grid
+inline uint64_t mortonEncode(glm::vec3 p, glm::vec3 lo, glm::vec3 extent) {
+  constexpr float cells{float(1u << mortonBitsPerAxis) - 1};
+  auto q{glm::clamp((p - lo) / glm::max(extent, glm::vec3{1e-30f}), 0.0f,
+                    1.0f) *
+         cells};
+  return mortonEncode(uint32_t(q.x), uint32_t(q.y), uint32_t(q.z));
+}
+
+inline uint64_t mortonEncode(glm::vec3 p, const Aabb &box) {
+  return mortonEncode(p, box.a, box.size());
+}
+
+#endif  // MORTON_HPP
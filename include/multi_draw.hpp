@@ -0,0 +1,59 @@
+#ifndef MULTI_DRAW_HPP
+#define MULTI_DRAW_HPP
+
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+#include "gpu_resources.hpp"
+#include "instancing.hpp"
+
+// layout glMultiDrawElementsIndirect expects for every command
+struct DrawElementsIndirectCommand {
+  GLuint count, instanceCount, firstIndex;
+  GLint baseVertex;
+  GLuint baseInstance;
+};
+
+// Turns the instanced batches into indirect draw commands over the mesh
+// arena. Adjacent commands sharing a pass and a texture are issued by a single
+// glMultiDrawElementsIndirect, so a frame costs one call per texture rather
+// than a handful of state changes per batch. Whether a range is textured
+// picks the program variant it is drawn with, so draws carry no data of
+// their own.
+class MultiDraw {
+ public:
+  struct Range {
+    RenderQueue::Pass pass;
+    const std::string *texture;  // see InstanceBatcher::Batch
+    GLuint firstDraw;
+    GLsizei drawCount;
+  };
+
+  MultiDraw();
+  MultiDraw(const MultiDraw &other) = delete;
+  ~MultiDraw();
+
+  MultiDraw &operator=(const MultiDraw &other) = delete;
+
+  // must be called after every upload of the batcher, batches without
+  // instances being skipped
+  void build(const std::vector<InstanceBatcher::Batch> &batches,
+             const GpuResources &resources);
+
+  // binds the command buffer
+  void bind() const;
+
+  // issues every command of the range
+  void draw(const Range &range) const;
+
+  const std::vector<Range> &ranges() const;
+  const std::vector<DrawElementsIndirectCommand> &commands() const;
+
+ private:
+  std::vector<DrawElementsIndirectCommand> _commands;
+  std::vector<Range> _ranges;
+  GLuint _commandBuffer{};
+};
+
+#endif  // MULTI_DRAW_HPP
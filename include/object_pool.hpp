@@ -0,0 +1,74 @@
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Owns objects of one type, constructed in place in chunks of chunkSize
+// slots, so that they don't move and making many of them takes a handful of
+// allocations. Destroyed objects' slots are reused, newest first. Whatever is
+// left is destroyed along with the pool.
+//
+// Not thread-safe.
+template <class T, size_t chunkSize = 256>
+class ObjectPool {
+ public:
+  ObjectPool() = default;
+  ObjectPool(const ObjectPool &other) = delete;
+  ~ObjectPool() {
+    for (auto &chunk : _chunks)
+      for (size_t i = 0; i < chunkSize; ++i)
+        if (chunk[i].live) chunk[i].object()->~T();
+  }
+
+  ObjectPool &operator=(const ObjectPool &other) = delete;
+
+  template <class... Args>
+  T *create(Args &&...args) {
+    if (!_free) {
+      auto &chunk{_chunks.emplace_back(new Slot[chunkSize])};
+      for (size_t i = chunkSize; i-- > 0;) {
+        chunk[i].next = _free;
+        _free = &chunk[i];
+      }
+    }
+    auto slot{_free};
+    auto object{new (slot->storage) T(std::forward<Args>(args)...)};
+    _free = slot->next;
+    slot->live = true;
+    ++_size;
+    return object;
+  }
+
+  // object must have been created by this pool
+  void destroy(T *object) {
+    object->~T();
+    // the storage is the slot's first member
+    auto slot{reinterpret_cast<Slot *>(object)};
+    slot->live = false;
+    slot->next = _free;
+    _free = slot;
+    --_size;
+  }
+
+  // objects alive
+  size_t size() const { return _size; }
+
+ private:
+  struct Slot {
+    T *object() { return std::launder(reinterpret_cast<T *>(storage)); }
+
+    alignas(T) unsigned char storage[sizeof(T)];
+    Slot *next;
+    bool live{};
+  };
+
+  std::vector<std::unique_ptr<Slot[]>> _chunks;
+  Slot *_free{};
+  size_t _size{};
+};
+
+#endif  // OBJECT_POOL_HPP
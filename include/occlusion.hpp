@@ -0,0 +1,77 @@
+#ifndef OCCLUSION_HPP
+#define OCCLUSION_HPP
+
+#include <vector>
+
+#include "aabb.hpp"
+#include "actor.hpp"
+#include "frame_arena.hpp"
+
+// Software occlusion culling. The triangles of a few chosen occluders are
+// rasterized on the CPU into a small depth buffer, tile by tile in parallel
+// and four pixels at a time, and a min/max pyramid is built over it. Actors
+// whose screen-projected bounds are behind the occluders everywhere can then
+// be skipped before anything is sent to the GPU.
+//
+// Depths are window-space, 0 at the near plane and 1 at the far plane. The
+// test is conservative: occluder triangles crossing the near plane are
+// dropped, and boxes are tested against their nearest corner over every
+// pixel their projection touches.
+class OcclusionCuller {
+ public:
+  static constexpr int width{256}, height{128};
+  static constexpr int tileWidth{32}, tileHeight{16};
+  static constexpr int tilesX{width / tileWidth}, tilesY{height / tileHeight};
+
+  // triangle ready to be rasterized: edge functions are positive inside, and
+  // depth is a plane over the screen
+  struct Triangle {
+    float edgeA[3], edgeB[3], edgeC[3];
+    float depthA, depthB, depthC;
+    int minX, minY, maxX, maxY;
+  };
+
+  OcclusionCuller();
+
+  // rasterizes the occluders, as seen through viewProjection, into the depth
+  // buffer, and rebuilds the pyramid
+  void render(const std::vector<const Actor *> &occluders,
+              const mat4 &viewProjection);
+
+  // whether any part of the box may be in front of the occluders
+  bool isVisible(const Aabb &bounds) const;
+
+  // removes the actors hidden behind the occluders, keeping the order of the
+  // rest; tests run in parallel
+  void cull(std::vector<const Actor *> &actors) const;
+
+  // occluder triangles of the last render, clipped to the screen
+  const std::vector<Triangle> &triangles() const;
+  const std::vector<float> &depthBuffer() const;
+
+  // sets up a triangle from window-space vertices (x and y in pixels, z in
+  // [0, 1]); false if it is degenerate or entirely off screen
+  static bool setUp(vec3 v0, vec3 v1, vec3 v2, Triangle &triangle);
+
+ private:
+  void _rasterizeTile(int tile);
+  void _buildPyramid();
+  bool _visibleIn(int level, int x0, int y0, int x1, int y1,
+                  float nearest) const;
+
+  mat4 _viewProjection{1};
+  std::vector<Triangle> _triangles;
+  std::vector<std::vector<unsigned>> _bins;  // triangles touching each tile
+
+  // level 0 is the depth buffer itself, shared by both pyramids
+  struct Level {
+    int width, height;
+    std::vector<float> min, max;
+  };
+  std::vector<Level> _levels;
+
+  // scratch of render() and cull(), rewound by every render()
+  mutable FrameArena _arena;
+};
+
+#endif  // OCCLUSION_HPP
@@ -0,0 +1,36 @@
+#ifndef OFFSCREEN_TARGET_HPP
+#define OFFSCREEN_TARGET_HPP
+
+#include "glad/glad.h"
+#include "ppm.hpp"
+
+// Framebuffer standing in for the window's when rendering headless, or
+// deferred, with the color and depth formats of a single-sampled window, so
+// that the passes drawing into it, and blitting into it, need not know the
+// difference.
+class OffscreenTarget {
+ public:
+  OffscreenTarget();
+  OffscreenTarget(const OffscreenTarget &other) = delete;
+  ~OffscreenTarget();
+
+  OffscreenTarget &operator=(const OffscreenTarget &other) = delete;
+
+  // reallocates the attachments when the size changed
+  void resize(GLsizei width, GLsizei height);
+
+  GLuint framebuffer() const;
+
+  // copies the color into an image of the same size, flipping it so that
+  // rows go top to bottom; waits for drawing to finish
+  void read(PortablePixelMap &image) const;
+  // copies the color into a framebuffer of the same size, be it
+  // multisampled, and leaves that one bound
+  void copyTo(GLuint framebuffer) const;
+
+ private:
+  GLuint _framebuffer{}, _color{}, _depth{};
+  GLsizei _width{}, _height{};
+};
+
+#endif  // OFFSCREEN_TARGET_HPP
@@ -11,8 +11,8 @@ class GraphicalParticle : public Actor {
       : Actor{"tmp", particle_mesh_}, particle_{particle} {
     _name = std::string{"particle_"} + std::to_string(current_particle_id_++);
     // Make particles show up as red spheres
-    material.Kd = {1, 0, 0};
-    material.Ns = 0;
+    material().Kd = {1, 0, 0};
+    material().Ns = 0;
     this->scale(0.1);
   }
 
@@ -8,6 +8,11 @@ namespace phys {
 
 class ParticleForceGenerator {
  public:
+  // Called once per step by a ParticleForceRegistry, before any ApplyForce
+  // of that step, for generators that precompute something over all of
+  // their particles
+  virtual void BeginStep(Float time_step) {}
+
   virtual void ApplyForce(Particle* particle, Float time_step) = 0;
 };
 
@@ -1,9 +1,11 @@
 #ifndef PHYSICS_PARTICLE_FORCE_REGISTRY_HPP_
 #define PHYSICS_PARTICLE_FORCE_REGISTRY_HPP_
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
+#include "cpu_profiler.hpp"
 #include "physics/particle_force_generator.hpp"
 
 namespace phys {
@@ -12,17 +14,31 @@ class ParticleForceRegistry {
  public:
   void Register(Particle* particle, ParticleForceGenerator* force_generator) {
     registrations_.push_back({particle, force_generator});
+    if (std::find(generators_.begin(), generators_.end(), force_generator) ==
+        generators_.end())
+      generators_.push_back(force_generator);
   }
 
   void Unregister(Particle* particle, ParticleForceGenerator* force_generator) {
     auto new_end = std::remove(registrations_.begin(), registrations_.end(),
                                Registration{particle, force_generator});
     registrations_.erase(new_end, registrations_.end());
+    if (std::none_of(registrations_.begin(), registrations_.end(),
+                     [=](const Registration& registration) {
+                       return registration.second == force_generator;
+                     }))
+      std::erase(generators_, force_generator);
   }
 
-  void Clear() { registrations_.clear(); }
+  void Clear() {
+    registrations_.clear();
+    generators_.clear();
+  }
 
   void ApplyForces(Float time_step) const {
+    PROFILE_ZONE("ParticleForceRegistry::ApplyForces");
+    for (auto force_generator : generators_)
+      force_generator->BeginStep(time_step);
     for (auto& [particle, force_generator] : registrations_)
       force_generator->ApplyForce(particle, time_step);
   }
@@ -31,6 +47,8 @@ class ParticleForceRegistry {
   using Registration = std::pair<Particle*, ParticleForceGenerator*>;
 
   std::vector<Registration> registrations_;
+  // every generator registered, once
+  std::vector<ParticleForceGenerator*> generators_;
 };
 
 }  // namespace phys
@@ -0,0 +1,261 @@
+#ifndef PHYSICS_PARTICLE_NBODY_GRAVITY_HPP_
+#define PHYSICS_PARTICLE_NBODY_GRAVITY_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "cpu_profiler.hpp"
+#include "job_system.hpp"
+#include "morton.hpp"
+#include "physics/particle_force_generator.hpp"
+#include "radix_sort.hpp"
+
+namespace phys {
+
+// Mutual gravitation between a set of particles, approximated with a
+// Barnes-Hut octree. The octree is linear: particles are sorted by Morton code,
+// so every cell is a contiguous range of that order, and nodes are stored in
+// pre-order with a skip index, so traversal needs no stack.
+class ParticleNBodyGravity : public ParticleForceGenerator {
+ public:
+  explicit ParticleNBodyGravity(
+      Float opening_angle = default_opening_angle_,
+      Float gravitational_constant = default_gravitational_constant_,
+      Float softening = default_softening_)
+      : opening_angle_{opening_angle},
+        gravitational_constant_{gravitational_constant},
+        softening_{softening} {}
+
+  void AddParticle(Particle* particle) {
+    if (std::find(particles_.begin(), particles_.end(), particle) ==
+        particles_.end())
+      particles_.push_back(particle);
+  }
+
+  void RemoveParticle(Particle* particle) { std::erase(particles_, particle); }
+
+  // Smaller angles are more accurate, 0 degenerates into brute force
+  void SetOpeningAngle(Float opening_angle) {
+    assert(opening_angle >= 0);
+    opening_angle_ = opening_angle;
+  }
+
+  void SetMaxLeafSize(uint32_t max_leaf_size) {
+    assert(max_leaf_size > 0);
+    max_leaf_size_ = max_leaf_size;
+  }
+
+  Float GetOpeningAngle() const { return opening_angle_; }
+
+  size_t GetNodeCount() const { return nodes_.size(); }
+
+  // Rebuilds the octree from the current particle positions
+  void BuildTree() {
+    PROFILE_ZONE("ParticleNBodyGravity::BuildTree");
+    bodies_.resize(particles_.size());
+    nodes_.clear();
+    if (particles_.empty()) return;
+
+    Aabb box;
+    for (auto particle : particles_) box.inflate(particle->GetPosition());
+    // the root cell is a cube, so cell sizes are the same along every axis
+    auto extent = glm::max(box.size().x, glm::max(box.size().y, box.size().z));
+    root_corner_ = box.a;
+    root_size_ = extent > 0 ? extent : 1;
+
+    for (size_t i = 0; i < particles_.size(); ++i) {
+      auto particle = particles_[i];
+      bodies_[i] = {particle->GetPosition(), SourceMass(particle),
+                    Encode(particle->GetPosition()), particle};
+    }
+    radixSort(bodies_, scratch_, [](const Body& body) { return body.code; });
+
+    MakeNode(0, uint32_t(bodies_.size()), 0, Float(root_size_));
+
+    // mass aggregates, bottom-up: in pre-order children always come after
+    // their parent, so a reverse sweep sees every child before its parent
+    for (auto i = nodes_.size(); i-- > 0;) {
+      auto& node = nodes_[i];
+      Vector3 weighted{};
+      Float mass{};
+      if (node.leaf) {
+        for (auto b = node.first; b < node.first + node.count; ++b) {
+          weighted += bodies_[b].mass * bodies_[b].position;
+          mass += bodies_[b].mass;
+        }
+      } else {
+        for (auto c = uint32_t(i) + 1; c < node.next; c = nodes_[c].next) {
+          weighted += nodes_[c].mass * nodes_[c].center_of_mass;
+          mass += nodes_[c].mass;
+        }
+      }
+      node.mass = mass;
+      node.center_of_mass =
+          mass > 0 ? weighted / mass : bodies_[node.first].position;
+    }
+  }
+
+  // Builds the octree and adds the gravitational pull to every registered
+  // particle, evaluating the particles in parallel
+  void ApplyForces(Float time_step) {
+    PROFILE_ZONE("ParticleNBodyGravity::ApplyForces");
+    BuildTree();
+    JobSystem::instance().parallelFor(
+        0, bodies_.size(), 64, [this](size_t first, size_t last) {
+          for (auto i = first; i < last; ++i) {
+            const auto& body = bodies_[i];
+            if (body.particle->HasFiniteMass())
+              body.particle->ApplyForce(Evaluate(body.position, body.mass,
+                                                 body.code, body.particle));
+          }
+        });
+  }
+
+  // Registered in a ParticleForceRegistry, the tree is rebuilt at the start
+  // of every step, before any particle is evaluated against it
+  void BeginStep(Float time_step) override { BuildTree(); }
+
+  // Evaluates a single particle against the last built tree; outside of a
+  // registry, BuildTree() has to be called first every step
+  void ApplyForce(Particle* particle, Float time_step) override {
+    if (particle->HasFiniteMass()) particle->ApplyForce(ComputeForce(particle));
+  }
+
+  Vector3 ComputeForce(const Particle* particle) const {
+    if (nodes_.empty()) return {};
+    return Evaluate(particle->GetPosition(), particle->GetMass(),
+                    Encode(particle->GetPosition()), particle);
+  }
+
+  // Exact O(n) sum over all other particles, the reference used to measure the
+  // error of the approximation
+  Vector3 ComputeForceBruteForce(const Particle* particle) const {
+    Vector3 force{};
+    for (auto other : particles_)
+      if (other != particle)
+        force += Attraction(particle->GetPosition(), other->GetPosition(),
+                            SourceMass(other));
+    return gravitational_constant_ * particle->GetMass() * force;
+  }
+
+ private:
+  struct Body {
+    Vector3 position;
+    Float mass;
+    uint64_t code;
+    Particle* particle;
+  };
+
+  struct Node {
+    Vector3 center_of_mass;
+    Float mass;
+    Float size;             // edge length of the cell
+    uint64_t prefix;        // Morton code prefix shared by the whole cell
+    uint32_t first, count;  // range of bodies_ covered by the cell
+    uint32_t next;          // next node in pre-order that is not a descendant
+    uint8_t level;
+    bool leaf;
+  };
+
+  static constexpr Float default_opening_angle_{0.5};
+  static constexpr Float default_gravitational_constant_{6.674e-11};
+  static constexpr Float default_softening_{1e-3};
+
+  // Anchored particles have infinite mass, they are not used as sources
+  static Float SourceMass(const Particle* particle) {
+    return particle->HasFiniteMass() ? particle->GetMass() : 0;
+  }
+
+  static unsigned PrefixShift(unsigned level) {
+    return 3 * (mortonBitsPerAxis - level);
+  }
+
+  uint64_t Encode(const Vector3& position) const {
+    return mortonEncode(glm::vec3{position}, root_corner_,
+                        glm::vec3{root_size_});
+  }
+
+  void MakeNode(uint32_t first, uint32_t count, unsigned level, Float size) {
+    auto index = uint32_t(nodes_.size());
+    nodes_.push_back({{},
+                      0,
+                      size,
+                      bodies_[first].code >> PrefixShift(level),
+                      first,
+                      count,
+                      0,
+                      uint8_t(level),
+                      true});
+
+    if (count > max_leaf_size_ && level < mortonBitsPerAxis) {
+      nodes_[index].leaf = false;
+      // the octant of a body at this level is the next 3-bit digit of its code
+      auto shift = PrefixShift(level + 1);
+      auto end = first + count;
+      for (auto begin = first; begin < end;) {
+        auto octant = unsigned(bodies_[begin].code >> shift) & 7;
+        auto it = std::partition_point(
+            bodies_.begin() + begin, bodies_.begin() + end,
+            [=](const Body& body) {
+              return (unsigned(body.code >> shift) & 7) == octant;
+            });
+        auto child_end = uint32_t(it - bodies_.begin());
+        MakeNode(begin, child_end - begin, level + 1, Float(0.5) * size);
+        begin = child_end;
+      }
+    }
+    nodes_[index].next = uint32_t(nodes_.size());
+  }
+
+  Vector3 Attraction(const Vector3& at, const Vector3& from,
+                     Float mass) const {
+    auto r = from - at;
+    auto d2 = glm::dot(r, r) + softening_ * softening_;
+    return (mass / (d2 * std::sqrt(d2))) * r;
+  }
+
+  Vector3 Evaluate(const Vector3& position, Float mass, uint64_t code,
+                   const Particle* self) const {
+    Vector3 force{};
+    auto theta2 = opening_angle_ * opening_angle_;
+    for (uint32_t i = 0; i < nodes_.size();) {
+      const auto& node = nodes_[i];
+      if (node.leaf) {
+        for (auto b = node.first; b < node.first + node.count; ++b)
+          if (bodies_[b].particle != self)
+            force +=
+                Attraction(position, bodies_[b].position, bodies_[b].mass);
+        i = node.next;
+        continue;
+      }
+      auto r = node.center_of_mass - position;
+      // a cell containing the particle itself is never approximated, otherwise
+      // the particle would be attracted to its own mass
+      auto inside = (code >> PrefixShift(node.level)) == node.prefix;
+      // far enough away for the whole cell to act as a single point mass
+      if (!inside && node.size * node.size < theta2 * glm::dot(r, r)) {
+        force += Attraction(position, node.center_of_mass, node.mass);
+        i = node.next;
+      } else {
+        ++i;
+      }
+    }
+    return gravitational_constant_ * mass * force;
+  }
+
+  std::vector<Particle*> particles_;
+  std::vector<Body> bodies_;
+  std::vector<Body> scratch_;  // for sorting bodies_
+  std::vector<Node> nodes_;
+  glm::vec3 root_corner_{};
+  float root_size_{1};
+  Float opening_angle_;
+  Float gravitational_constant_;
+  Float softening_;
+  uint32_t max_leaf_size_{8};
+};
+
+}  // namespace phys
+
+#endif  // PHYSICS_PARTICLE_NBODY_GRAVITY_HPP_
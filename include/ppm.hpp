@@ -9,14 +9,23 @@
 class PortablePixelMap {
 public:
   PortablePixelMap(const std::string &fileName);
+  // a black image, rows top to bottom, 3 bytes per pixel
+  PortablePixelMap(size_t width, size_t height);
+  PortablePixelMap(const PortablePixelMap &other) = delete;
 
   ~PortablePixelMap();
 
+  PortablePixelMap &operator=(const PortablePixelMap &other) = delete;
+
   const char *pixels() const;
+  char *pixels();
 
   size_t width() const;
   size_t height() const;
 
+  // saves as binary P6, returning whether it succeeded
+  bool write(const std::string &fileName) const;
+
 private:
   char *_pixels{};
   size_t _width{}, _height{};
@@ -0,0 +1,44 @@
+#ifndef RADIX_SORT_HPP
+#define RADIX_SORT_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Sorts items by the unsigned integer keyOf returns for them, one byte at a
+// time from the least significant one. Stable and linear in the number of
+// items; passes over bytes every key shares are skipped, so small keys cost
+// little more than a single pass. scratch is resized as needed and can be
+// reused across calls to avoid allocating.
+template <class T, class KeyOf>
+void radixSort(std::vector<T> &items, std::vector<T> &scratch, KeyOf keyOf) {
+  using Key = decltype(keyOf(items[0]));
+  static_assert(std::is_unsigned_v<Key>, "radix sort keys must be unsigned");
+
+  if (items.empty()) return;
+  scratch.resize(items.size());
+  for (unsigned shift = 0; shift < 8 * sizeof(Key); shift += 8) {
+    std::array<size_t, 256> offsets{};
+    for (auto &item : items) ++offsets[(keyOf(item) >> shift) & 0xff];
+    if (offsets[(keyOf(items[0]) >> shift) & 0xff] == items.size()) continue;
+
+    size_t offset{};
+    for (auto &count : offsets) offset += std::exchange(count, offset);
+    for (auto &item : items)
+      scratch[offsets[(keyOf(item) >> shift) & 0xff]++] = std::move(item);
+    items.swap(scratch);
+  }
+}
+
+// bits of a float ordered as the float itself when compared as unsigned
+inline uint32_t sortableBits(float f) {
+  auto bits{std::bit_cast<uint32_t>(f)};
+  // negatives have their order reversed, and all must come before positives
+  return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+}
+
+#endif  // RADIX_SORT_HPP
@@ -0,0 +1,66 @@
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "actor.hpp"
+#include "frame_arena.hpp"
+
+// Everything to be drawn in a frame, each item keyed by the state it is drawn
+// with and its depth. Keys pack, from the most significant bits down, the
+// pass, the program, the texture, the mesh and the depth, so that once sorted
+// items sharing a state are adjacent, states that are costlier to change
+// change least often, and items sharing all of them go front to back.
+class RenderQueue {
+ public:
+  enum Pass : unsigned { opaque, outline };
+
+  struct Item {
+    uint64_t key;
+    const Actor *actor;
+  };
+
+  static constexpr unsigned depthBits{24}, meshBits{16}, textureBits{16},
+                            programBits{6}, passBits{2};
+
+  void clear();
+
+  // queues the actor, drawn in the given pass with the given program; depth
+  // is the view distance it is ordered by among items of the same state
+  void push(const Actor *actor, Pass pass, unsigned program, float depth);
+
+  // radix sorts the items by key
+  void sort();
+
+  const std::vector<Item> &items() const;
+
+  // the key without its depth; items of the same state are drawn together
+  static uint64_t stateOf(uint64_t key);
+  static Pass passOf(uint64_t key);
+
+ private:
+  unsigned _textureId(const std::string &texture);
+  unsigned _meshId(const TriangleMesh *mesh);
+
+  template <class K>
+  using IdMap =
+      std::unordered_map<K, unsigned, std::hash<K>, std::equal_to<K>,
+                         FrameAllocator<std::pair<const K, unsigned>>>;
+
+  std::vector<Item> _items, _scratch;
+  // small ids standing for the textures and meshes queued since the last
+  // clear() within keys; 0 is no texture. They are made anew from the
+  // arena, rewound in between, so that steady frames don't allocate, and
+  // textures are keyed by the materials' own strings
+  FrameArena _idArena{4096};
+  std::optional<IdMap<std::string_view>> _textureIds{std::in_place, _idArena};
+  std::optional<IdMap<const TriangleMesh *>> _meshIds{std::in_place,
+                                                      _idArena};
+};
+
+#endif  // RENDER_QUEUE_HPP
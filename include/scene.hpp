@@ -1,15 +1,20 @@
 #ifndef SCENE_HPP
 #define SCENE_HPP
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <unordered_set>
 
 #include "actor.hpp"
 #include "camera.hpp"
 #include "custom_assert.hpp"
 #include "gl_util.hpp"
 #include "light.hpp"
+#include "object_pool.hpp"
+#include "scene_graph.hpp"
 #include "shader_sources.hpp"
 #include "window.hpp"
 
@@ -18,15 +23,49 @@ class Scene {
   void addActor(Actor* actor);
   void addCamera(Camera* camera);
   void addLight(Light* light);
+  // these add objects of the scene's own, kept in pools and freed along with
+  // it, or when removed through its menus; meshes are only kept, for actors
+  // to use
+  Actor* createActor(Actor actor);
+  Camera* createCamera(Camera camera);
+  Light* createLight(Light light);
+  const TriangleMesh* createMesh(TriangleMeshData data);
+  // both already in the scene; a null parent makes object a root again
+  void setParent(TransformableObject* object, TransformableObject* parent);
 
   void render(
       const Window& window, const std::function<void()>& f = [] {});
 
+  // a fixed run, for benchmarks and golden-image tests
+  struct Script {
+    unsigned frameCount{};
+    // fixed, so that runs are reproducible; also what timeStep() returns
+    float timeStep{1 / 60.0f};
+    // places the camera for the frame at time t, in seconds
+    std::function<void(Camera& camera, float t)> cameraPath;
+    // frames are saved as <framePrefix>0000.ppm and on, unless empty
+    std::string framePrefix;
+    // per-frame CPU and GPU times are saved here as JSON, unless empty
+    std::string timingsFile;
+    // per-pass GPU times of the last frames are saved here as CSV, unless
+    // empty; see GpuProfiler
+    std::string passTimingsFile;
+  };
+
+  // renders the frames of the script offscreen and without user interface,
+  // calling f after each; meant for headless windows
+  void renderHeadless(
+      const Window& window, const Script& script,
+      const std::function<void()>& f = [] {});
+
   const std::vector<Actor*>& actors() const;
   const std::vector<Light*>& lights() const;
+  const SceneGraph& graph() const { return _graph; }
 
   struct Options {
-    bool toneMap{}, wireframe{}, desaturate{};
+    bool toneMap{}, wireframe{}, desaturate{}, frustumCulling{true},
+        occlusionCulling{}, deferredShading{}, depthPrepass{},
+        frontToBack{true}, pbr{};
   } options;
 
   vec3 ambient{};
@@ -34,12 +73,32 @@ class Scene {
   float timeStep() const { return _timeStep; }
 
  private:
-  void _addChildren(Object* object);
+  // script is null when rendering to the window until it is closed
+  void _render(const Window& window, const std::function<void()>& f,
+               const Script* script);
+
+  ObjectPool<TriangleMesh> _meshPool;
+  ObjectPool<Actor> _actorPool;
+  ObjectPool<Camera> _cameraPool;
+  ObjectPool<Light> _lightPool;
+  // what came from the pools above, as opposed to what was only added
+  std::unordered_set<const TransformableObject*> _created;
 
   std::vector<Camera*> _cameras;
   std::vector<Actor*> _actors;
+  std::vector<Actor*> _newActors;  // not yet resident on the GPU
   std::vector<Light*> _lights;
-  TransformableObject* _currentObject;
+  // every camera, actor and light, the world matrices of which are brought up
+  // to date once a frame
+  SceneGraph _graph;
+  // what the properties window edits, and the same again as whichever of
+  // the kinds below it is, so that frames don't need to cast it
+  struct {
+    TransformableObject* object;
+    Actor* actor;
+    Camera* camera;
+    Light* light;
+  } _selected{};
   float _timeStep{};
 };
 
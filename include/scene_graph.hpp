@@ -0,0 +1,65 @@
+#ifndef SCENE_GRAPH_HPP
+#define SCENE_GRAPH_HPP
+
+#include <vector>
+
+#include "transformable_object.hpp"
+
+// Parents objects to one another, so that a child's transform is relative to
+// its parent's. Nodes are kept in flat arrays, in depth-first order, so that
+// every parent comes before its children and every root's subtree is a
+// contiguous run of nodes. Changing an object flags its node; update() then
+// recomputes, in one sweep, the world matrices of the flagged nodes and of
+// everything under them, with the roots' subtrees swept in parallel.
+//
+// The graph doesn't own its objects. An object is in one graph at a time and
+// leaves it when destroyed. Objects in one graph shouldn't be changed from
+// several threads at once.
+class SceneGraph {
+public:
+  static constexpr int null{-1};
+
+  SceneGraph() = default;
+  SceneGraph(const SceneGraph &) = delete;
+  SceneGraph &operator=(const SceneGraph &) = delete;
+  ~SceneGraph();
+
+  // as a root
+  void add(TransformableObject *object);
+  // puts object, already in the graph, under parent, or makes it a root again
+  // if parent is null; it keeps its local transform, so it moves along
+  void setParent(TransformableObject *object, TransformableObject *parent);
+  // its children become roots, as of the next update
+  void remove(TransformableObject *object);
+
+  // brings the world matrices of whatever changed since the last call, and
+  // of everything under it, up to date; children that moved are told so
+  void update();
+
+  size_t size() const { return _objects.size(); }
+  TransformableObject *object(int node) const { return _objects[node]; }
+  int parent(int node) const { return _parents[node]; }
+  // as of the last update(); invalidated by adding and removing objects
+  const mat4 &world(int node) const { return _worlds[node]; }
+
+private:
+  friend class TransformableObject;
+
+  void _markDirty(int node);
+  // drops removed nodes and restores the depth-first order
+  void _sort();
+
+  std::vector<TransformableObject *> _objects; // null once removed
+  std::vector<int> _parents;
+  std::vector<mat4> _locals, _worlds;
+  // whose local transform changed since the last update, and whose world
+  // matrix changed in this one
+  std::vector<char> _dirty, _moved;
+  // the first node of every root's subtree, then the node count
+  std::vector<int> _roots;
+  std::vector<int> _rootOf;      // the subtree every node is in
+  std::vector<char> _rootDirty;  // whether any node in the subtree is
+  bool _sorted{true};
+};
+
+#endif // SCENE_GRAPH_HPP
@@ -0,0 +1,57 @@
+#ifndef SHADER_PERMUTATIONS_HPP
+#define SHADER_PERMUTATIONS_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glad/glad.h"
+
+// Variants of a program, one per combination of features. Each feature is a
+// #define prepended to the sources, so that what used to be branches on
+// uniforms is resolved when compiling. Variants are built the first time they
+// are asked for, then kept; their binaries are also saved to disk and loaded
+// back on later runs, as long as the sources and the driver are the same.
+class ShaderPermutations {
+ public:
+  enum Feature : unsigned {
+    textured = 1 << 0,
+    wireframe = 1 << 1,
+    selected = 1 << 2,
+    toneMap = 1 << 3,
+    desaturate = 1 << 4,
+    pbr = 1 << 5,
+    featureCount = 6
+  };
+
+  static inline std::filesystem::path cacheDirectory{"shader_cache"};
+
+  // each stage is the concatenation of its sources, which must not declare a
+  // #version; programs without fragment sources only write depth. name tells
+  // apart the cached binaries of different programs
+  ShaderPermutations(std::string name, std::vector<const char *> vertexSources,
+                     std::vector<const char *> fragmentSources);
+  ShaderPermutations(const ShaderPermutations &other) = delete;
+  ~ShaderPermutations();
+
+  ShaderPermutations &operator=(const ShaderPermutations &other) = delete;
+
+  // the variant with the given features, loading or compiling it if needed
+  GLuint program(unsigned features);
+
+  size_t variantCount() const;
+
+ private:
+  GLuint _compile(const std::string &defines) const;
+  GLuint _load(const std::filesystem::path &path, uint64_t hash) const;
+  void _save(GLuint program, const std::filesystem::path &path,
+             uint64_t hash) const;
+
+  std::string _name;
+  std::vector<const char *> _vertexSources, _fragmentSources;
+  std::unordered_map<unsigned, GLuint> _variants;
+};
+
+#endif  // SHADER_PERMUTATIONS_HPP
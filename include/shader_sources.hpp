@@ -1,246 +1,292 @@
 #ifndef SHADER_SOURCES_HPP
 #define SHADER_SOURCES_HPP
 
-#include <string>
+// Pieces the programs are put together from, see ShaderPermutations. None
+// declares a #version, which comes first along with the defines of the
+// variant being built, and BASE_INSTANCE, standing for gl_BaseInstance.
+
+// see FrameUniforms
+static constexpr auto frameBlock = R"(
+layout (std140, binding = 0) uniform Frame {
+  mat4 V, P, invP;
+  vec4 ambient;
+  vec2 clusterTan, clusterDepth;
+  uvec3 clusterCount;
+  uint firstObject;
+};
 
-static constexpr auto triangleMeshVertexShader = R"(
-#version 440
+)";
+
+// per-instance data, see InstanceData
+static constexpr auto objectsBlock = R"(
+struct ObjectData {
+  mat4 M;
+  vec4 KaNs, KdNi, KsD;
+};
+
+layout (std430, binding = 1) readonly buffer Objects {
+  ObjectData objects[];
+};
+
+)";
 
+static constexpr auto triangleMeshVertexShader = R"(
 layout (location = 0) in vec3 p;
 layout (location = 1) in vec3 n;
 layout (location = 2) in vec2 uv;
 
-uniform mat4 M;
-uniform mat4 V;
-uniform mat4 P;
-
-uniform bool selected;
-
 out vec3 v_p;
 out vec3 v_n;
 out vec2 v_uv;
 
+flat out vec3 v_Ka, v_Kd, v_Ks;
+flat out float v_Ns, v_Ni, v_d;
+
+// depthOnlyVertexShader must land on exactly the same depths
+invariant gl_Position;
+
 void main(void) {
-  mat4 MV = V * M;
+  uint instance = firstObject + uint(BASE_INSTANCE + gl_InstanceID);
+  ObjectData object = objects[instance];
+  mat4 MV = V * object.M;
   v_p = vec3(MV * vec4(p, 1));
   v_n = transpose(inverse(mat3(MV))) * n;
-  if (selected)
-    v_p += 0.00001 * v_n;
   v_uv = uv;
+  v_Ka = object.KaNs.xyz;
+  v_Kd = object.KdNi.xyz;
+  v_Ks = object.KsD.xyz;
+  v_Ns = object.KaNs.w;
+  v_Ni = object.KdNi.w;
+  v_d = object.KsD.w;
   gl_Position = P * vec4(v_p, 1);
 }
 
 )";
 
-static constexpr auto triangleMeshPhongFragShader = R"(
-#version 440
-
-#define MAX_LIGHTS 100
-
-uniform struct Material {
-  vec3 Ka, Kd, Ks;
-  float Ns, Ni, d;
-} material;
-
-uniform struct Light {
-  vec3 color;
-  mat4 transform;
-} lights[MAX_LIGHTS];
+// positions alone, for the depth pre-pass; the expressions leading to
+// gl_Position are those of triangleMeshVertexShader, so that the passes after
+// it can test for equal depths
+static constexpr auto depthOnlyVertexShader = R"(
+layout (location = 0) in vec3 p;
 
-uniform uint lightCount;
-uniform mat4 V;
-uniform vec3 ambient;
-uniform bool selected;
-uniform bool toneMap;
-uniform bool wireframe;
-uniform bool desaturate;
-uniform bool textured;
+invariant gl_Position;
 
-uniform sampler2D tex;
+void main(void) {
+  uint instance = firstObject + uint(BASE_INSTANCE + gl_InstanceID);
+  mat4 MV = V * objects[instance].M;
+  vec3 v_p = vec3(MV * vec4(p, 1));
+  gl_Position = P * vec4(v_p, 1);
+}
 
-in vec3 v_p;
-in vec3 v_n;
-in vec2 v_uv;
+)";
 
-out vec4 fragColor;
+// lighting shared by the forward and deferred paths; PBR picks Oren-Nayar
+// diffuse and Cook-Torrance specular over wrapped diffuse and Blinn-Phong
+static constexpr auto shadingFunctions = R"(
+// see ClusterLight
+struct Light {
+  vec4 positionRange;
+  vec4 color;
+};
+
+layout (std430, binding = 2) readonly buffer Lights {
+  Light lights[];
+};
+
+// offset and count of the lights of every froxel within lightIndices
+layout (std430, binding = 3) readonly buffer Clusters {
+  uvec2 clusters[];
+};
+
+layout (std430, binding = 4) readonly buffer LightIndices {
+  uint lightIndices[];
+};
+
+// froxel holding a view-space point
+uint clusterOf(vec3 p) {
+  float depth = -p.z;
+  vec2 xy = floor((0.5 * p.xy / (depth * clusterTan) + 0.5)
+                  * vec2(clusterCount.xy));
+  xy = clamp(xy, vec2(0), vec2(clusterCount.xy) - 1.0);
+  float z = floor(log(depth) * clusterDepth.x + clusterDepth.y);
+  z = clamp(z, 0.0, float(clusterCount.z) - 1.0);
+  return (uint(z) * clusterCount.y + uint(xy.y)) * clusterCount.x
+         + uint(xy.x);
+}
 
-void main(void) {
-  if (wireframe) {
-    fragColor = vec4(0, 0.5, 1, 1);
-    if (selected)
-      fragColor = 1.0 - fragColor;
-    return;
-  }
+// inverse square falloff, lowered to reach zero at the light's range
+float attenuation(float d2, float range) {
+  return max(1.0 / d2 - 1.0 / (range * range), 0.0);
+}
 
-  if (selected) {
-    fragColor = vec4(0, 0.5, 1, 1);
-    return;
-  }
+// color of a view-space point lit by the lights of its froxel
+vec3 shade(vec3 p, vec3 n, vec3 Ka, vec3 Kd, vec3 Ks, float Ns) {
+  vec3 v = normalize(-p);
 
-  vec3 n = normalize(v_n);
-  vec3 v = normalize(-v_p);
+#ifdef PBR
+  const float pi = 3.1415926535;
+  float nDotV = clamp(dot(n, v), 0.0, 1.0);
+  float angleNV = acos(nDotV);
+  float roughness2 = 2.0 / (Ns + 2.0);
+  float A = 1.0 - 0.5 * (roughness2 / (roughness2 + 0.57));
+  float B = 0.45 * (roughness2 / (roughness2 + 0.09));
+  const float ior = 2.0;
+  float kr = pow((1.0 - ior) / (1.0 + ior), 2.0);
+  float g2 = (nDotV * 2.0)
+             / (nDotV + sqrt(roughness2 + (1.0 - roughness2) * nDotV * nDotV));
+#endif
+
+  vec3 color = ambient.rgb * Ka;
+  uvec2 cluster = clusters[clusterOf(p)];
+  for (uint c = 0u; c < cluster.y; ++c) {
+    Light light = lights[lightIndices[cluster.x + c]];
+    vec3 l = light.positionRange.xyz - p;
+    float d2 = dot(l, l);
+    l *= inversesqrt(d2);
+    vec3 radiance = light.color.rgb * attenuation(d2, light.positionRange.w);
+    vec3 h = normalize(v + l);
 
-  vec3 color = ambient * material.Ka;
-  for (int i = 0; i < lightCount; ++i) {
-    vec3 lp = vec3(
-        V * lights[i].transform * vec4(0, 0, 0, 1));
-    vec3 l = lp - v_p;
-    float invd = 1.0 / length(l);
-    l *= invd;
+#ifdef PBR
+    float nDotL = clamp(dot(n, l), 0.0, 1.0);
+    float angleLN = acos(nDotL);
+    float alpha = max(angleNV, angleLN);
+    float beta = min(angleNV, angleLN);
+    float gamma = cos(angleNV - angleLN);
+    float diffuse = nDotL * (A + B * max(0.0, gamma) * sin(alpha) * tan(beta));
 
+    float F = kr + (1.0 - kr) * pow(1.0 - nDotL, 5.0);
+    float nDotH = clamp(dot(n, h), 0.0, 1.0);
+    float nh2 = nDotH * nDotH;
+    float denom = nh2 * roughness2 + (1.0 - nh2);
+    float D = roughness2 / (pi * denom * denom);
+    float g1 = (nDotL * 2.0) / (nDotL + sqrt(roughness2 + (1.0 - roughness2)
+                                                       * nDotL * nDotL));
+    float specular = max((F * g1 * g2 * D) / (pi * nDotV), 0.0);
+#else
     float diffuse = 0.5 * dot(l, n) + 0.5;
     diffuse *= diffuse;
-
     float specular = 0.0;
-    if (material.Ns != 0.0) {
-      vec3 h = normalize(v + l);
-      specular = pow(max(dot(h, n), 0.0), material.Ns);
+    if (Ns != 0.0)
+      specular = pow(max(dot(h, n), 0.0), Ns);
+#endif
 
-      // vec3 r = normalize(2.0 * dot(n, l) * n - l);
-      // specular = pow(max(dot(v, r), 0.0), material.Ns);
-    }
-
-    vec3 t = vec3(1);
-    if (textured)
-      t = texture(tex, v_uv).xyz;
-
-    color += diffuse  * material.Kd * t * lights[i].color * invd * invd
-           + specular * material.Ks * lights[i].color * invd * invd;
+    color += (diffuse * Kd + specular * Ks) * radiance;
   }
+  return color;
+}
 
-  if (desaturate) {
-    float luma = dot(vec3(0.2126, 0.7152, 0.0722), color);
-    float desat = smoothstep(0.0, 1.0, luma);
-    color = mix(color, vec3(luma), desat);
-  }
-
-  if (toneMap)
-    color = color / (color + 1.0);
-
-  fragColor = vec4(color, 1);
+vec3 postProcess(vec3 color) {
+#ifdef DESATURATE
+  float luma = dot(vec3(0.2126, 0.7152, 0.0722), color);
+  float desat = smoothstep(0.0, 1.0, luma);
+  color = mix(color, vec3(luma), desat);
+#endif
+#ifdef TONE_MAP
+  color = color / (color + 1.0);
+#endif
+  return color;
 }
 
 )";
 
-static constexpr auto triangleMeshPbrtFragShader = R"(
-#version 460
-
-#define MAX_LIGHTS 100
-
-uniform struct Material {
-  vec3 Ka, Kd, Ks;
-  float Ns, Ni, d;
-} material;
-
-uniform struct Light {
-  vec3 color;
-  mat4 transform;
-} lights[MAX_LIGHTS];
-
-uniform uint lightCount;
-uniform mat4 V;
-uniform vec3 ambient;
-uniform bool selected;
-uniform bool toneMap;
-uniform bool wireframe;
-uniform bool desaturate;
-uniform bool textured;
-
-uniform sampler2D tex;
+// forward shading; wireframes and the selection outline are flat
+static constexpr auto triangleMeshFragShader = R"(
+layout (binding = 0) uniform sampler2D tex;
 
 in vec3 v_p;
 in vec3 v_n;
 in vec2 v_uv;
 
+flat in vec3 v_Ka, v_Kd, v_Ks;
+flat in float v_Ns, v_Ni, v_d;
+
 out vec4 fragColor;
 
 void main(void) {
-  if (wireframe) {
-    fragColor = vec4(0, 0.5, 1, 1);
-    if (selected)
-      fragColor = 1.0 - fragColor;
-    return;
-  }
-
-  if (selected) {
-    fragColor = vec4(0, 0.5, 1, 1);
-    return;
-  }
-
-  vec3 n = normalize(v_n);
-  vec3 v = normalize(-v_p);
-
-  float nDotV = clamp(dot(n, v), 0.0, 1.0);
-  float angleNV = acos(nDotV);
-
-  vec3 color = ambient * material.Ka;
-
-  for (int i = 0; i < lightCount; ++i) {
-    vec3 lp = vec3(
-        V * lights[i].transform * vec4(0, 0, 0, 1));
-    vec3 l = lp - v_p;
-    float invd = 1.0 / length(l);
-    l *= invd;
-
-    float nDotL = clamp(dot(n, l), 0.0, 1.0);
-    float angleLN = acos(nDotL);
-
-    float alpha = max(angleNV, angleLN);
-    float beta = min(angleNV, angleLN);
-    float gamma = cos(angleNV - angleLN);
-
-    float roughness = sqrt(2.0 / (material.Ns + 2.0));
-    float roughness2 = roughness * roughness;
+#if defined(WIREFRAME) || defined(SELECTED)
+  fragColor = vec4(0, 0.5, 1, 1);
+#else
+  vec3 Kd = v_Kd;
+#ifdef TEXTURED
+  Kd *= texture(tex, v_uv).rgb;
+#endif
+  vec3 color = shade(v_p, normalize(v_n), v_Ka, Kd, v_Ks, v_Ns);
+  fragColor = vec4(postProcess(color), 1);
+#endif
+}
 
-    float A = 1.0 - 0.5 * (roughness2 / (roughness2 + 0.57));
-    float B = 0.45 * (roughness2 / (roughness2 + 0.09));
-    float C = sin(alpha) * tan(beta);
+)";
 
-    float diffuse = nDotL * (A + (B * max(0.0, gamma) * C));
+static constexpr auto triangleMeshGBufferFragShader = R"(
+layout (binding = 0) uniform sampler2D tex;
 
-    vec3 h = normalize(v + l);
-    const float ior = 2.0;
-    float kr = pow((1.0 - ior) / (1.0 + ior), 2.0);
-    float F = kr + (1.0 - kr) * pow((1.0 - nDotL), 5.0);
+in vec3 v_p;
+in vec3 v_n;
+in vec2 v_uv;
 
-    float nDotH = clamp(dot(n, h), 0.0, 1.0);
-    float nh2 = nDotH * nDotH;
-    
-    float denom = nh2 * roughness2 + (1.0 - nh2);
-    const float pi = 3.1415926535;
-    float D = roughness2 / (pi * denom * denom);
+flat in vec3 v_Ka, v_Kd, v_Ks;
+flat in float v_Ns, v_Ni, v_d;
 
-    float g1 = (nDotL * 2.0) / (nDotL + sqrt(roughness2 + (1.0 - roughness2) * nDotL * nDotL));
-    float g2 = (nDotV * 2.0) / (nDotV + sqrt(roughness2 + (1.0 - roughness2) * nDotV * nDotV));
-    float G = g1 * g2;
+// see GBuffer::Target
+layout (location = 0) out vec4 gNormal;    // view space, Ns in alpha
+layout (location = 1) out vec4 gAlbedo;    // Kd times the texture
+layout (location = 2) out vec4 gSpecular;  // Ks
+layout (location = 3) out vec4 gAmbient;   // Ka
 
-    float specular = max((F * G * D) / (pi * nDotV), 0.0);
+void main(void) {
+  vec3 Kd = v_Kd;
+#ifdef TEXTURED
+  Kd *= texture(tex, v_uv).rgb;
+#endif
+
+  gNormal = vec4(normalize(v_n), v_Ns);
+  gAlbedo = vec4(Kd, 1);
+  gSpecular = vec4(v_Ks, 1);
+  gAmbient = vec4(v_Ka, 1);
+}
 
-    vec3 t = vec3(1);
-    if (textured)
-      t = texture(tex, v_uv).xyz;
+)";
 
-    color += invd * invd * lights[i].color * (diffuse * material.Kd + specular * material.Ks);
-  }
+// a single triangle covering the whole screen, drawn without vertex data
+static constexpr auto fullScreenVertexShader = R"(
+void main(void) {
+  vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+  gl_Position = vec4(2.0 * p - 1.0, 0, 1);
+}
 
-  if (desaturate) {
-    float luma = dot(vec3(0.2126, 0.7152, 0.0722), color);
-    float desat = smoothstep(0.0, 1.0, luma);
-    color = mix(color, vec3(luma), desat);
-  }
+)";
 
-  if (toneMap)
-    color = color / (color + 1.0);
+static constexpr auto deferredLightingFragShader = R"(
+// right after the mesh textures' unit, see GBuffer::bindTextures
+layout (binding = 1) uniform sampler2D gNormal;
+layout (binding = 2) uniform sampler2D gAlbedo;
+layout (binding = 3) uniform sampler2D gSpecular;
+layout (binding = 4) uniform sampler2D gAmbient;
+layout (binding = 5) uniform sampler2D gDepth;
 
-  if (selected) {
-    vec3 fresnel = vec3(1, 0.5, 0);
-    float d = 1.0 - abs(dot(v, n));
-    color = mix(color, pow(d, 2.0) * fresnel, d);
-  }
+out vec4 fragColor;
 
-  fragColor = vec4(color, 1);
+void main(void) {
+  ivec2 pixel = ivec2(gl_FragCoord.xy);
+  float depth = texelFetch(gDepth, pixel, 0).r;
+  // nothing was drawn here, leaving the clear color
+  if (depth == 1.0)
+    discard;
+
+  // view-space position back from the depth
+  vec2 ndc = 2.0 * gl_FragCoord.xy / vec2(textureSize(gDepth, 0)) - 1.0;
+  vec4 q = invP * vec4(ndc, 2.0 * depth - 1.0, 1);
+  vec3 p = q.xyz / q.w;
+
+  vec4 normalNs = texelFetch(gNormal, pixel, 0);
+  vec3 Kd = texelFetch(gAlbedo, pixel, 0).rgb;
+  vec3 Ks = texelFetch(gSpecular, pixel, 0).rgb;
+  vec3 Ka = texelFetch(gAmbient, pixel, 0).rgb;
+
+  vec3 color = shade(p, normalNs.xyz, Ka, Kd, Ks, normalNs.w);
+  fragColor = vec4(postProcess(color), 1);
 }
 
 )";
 
-#endif  // SHADER_SOURCES_HPP
\ No newline at end of file
+#endif  // SHADER_SOURCES_HPP
@@ -9,7 +9,7 @@ void simulatePhysicsStep(const CollisionProps<T> &props, float dt) {
 
   constexpr float restitution{0.9f};
   auto &p{props.p}, &n{props.n};
-  auto &body1{props.body1}, &body2{props.body2};
+  auto &body1{props.body1.body()}, &body2{props.body2.body()};
   auto va{body1._velocity}, vb{body2._velocity};
   auto vab{va - vb};
   auto invma{body1._inverseMass}, invmb{body2._inverseMass};
@@ -26,9 +26,9 @@ void simulatePhysicsStep(const CollisionProps<T> &props, float dt) {
 
   // temporary fix for continued overlap
   if (invma != 0)
-    body1.translate(0.0001f * n);
+    props.body1.translate(0.0001f * n);
   if (invmb != 0)
-    body2.translate(-0.0001f * n);
+    props.body2.translate(-0.0001f * n);
 }
 
 #endif // SIMULATION_STEP_HPP
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef STREAM_RING_HPP
+#define STREAM_RING_HPP
+
+#include "glad/glad.h"
+
+// A persistently mapped buffer split into one section per frame in flight.
+// The CPU writes a frame's data straight into the next section while the GPU
+// may still be reading the previous ones; a fence per section makes sure a
+// section is never overwritten before the draws that read it are done.
+class StreamRing {
+ public:
+  static constexpr unsigned sections{3};
+
+  explicit StreamRing(size_t elementSize, size_t capacity = 256);
+  StreamRing(const StreamRing &other) = delete;
+  ~StreamRing();
+
+  StreamRing &operator=(const StreamRing &other) = delete;
+
+  // waits until the GPU is done with the next section and maps count
+  // elements of it, growing every section if they don't fit
+  void *begin(size_t count);
+
+  // fences the current section; must be called after the draws reading it
+  // have been issued
+  void end();
+
+  // index of the first element of the current section, as seen by shaders
+  // indexing the whole buffer
+  GLuint first() const;
+  GLuint buffer() const;
+
+  // bytes written during the last begin/end pair
+  size_t bytesStreamed() const;
+
+ private:
+  void _allocate(size_t capacity);
+  void _free();
+
+  size_t _elementSize, _capacity{};  // per section, in elements
+  GLuint _buffer{};
+  void *_mapped{};
+  GLsync _fences[sections]{};
+  unsigned _section{};
+  size_t _bytesStreamed{};
+};
+
+#endif  // STREAM_RING_HPP
@@ -6,6 +6,12 @@
 
 using namespace glm;
 
+class SceneGraph;
+
+// Keeps its position, rotation and scale apart, and only composes them into a
+// matrix when it is asked for after a change. Composing writes to the
+// object, so threads sharing one that may have changed should bring it up to
+// date with updateTransform() beforehand.
 class TransformableObject : public Object {
 public:
   TransformableObject(std::string name);
@@ -15,6 +21,9 @@ public:
   TransformableObject &operator=(const TransformableObject &other);
   TransformableObject &operator=(TransformableObject &&other) noexcept;
 
+  // leaves its scene graph, if any
+  ~TransformableObject() override;
+
   virtual void translate(vec3 xyz);
   virtual void rotate(vec3 euler);
   virtual void rotate(float angle, vec3 axis);
@@ -28,13 +37,41 @@ public:
   virtual vec3 scale() const;
   virtual void setScale(vec3 xyz);
 
+  const quat &orientation() const;
+
+  // object to world space
   const mat4 &transform() const;
-  mat4 &transform();
+  // world to object space, built from the parts on every call
+  mat4 inverseTransform() const;
+  // object-space normals to world space
+  mat3 normalMatrix() const;
+
+  void updateTransform() const;
+
+  // whether it is in a scene graph, under another object
+  bool hasParent() const;
+  // object to world space, through its parents, as of the graph's last update
+  const mat4 &worldTransform() const;
+  // world to object space, through its parents
+  mat4 inverseWorldTransform() const;
 
 protected:
-  mat4 _transform;
+  // called by the scene graph when a parent moved the object
+  virtual void _worldChanged() {}
 
 private:
+  friend class SceneGraph;
+
+  void _changed();
+
+  vec3 _position{};
+  quat _rotation{identity<quat>()};
+  vec3 _scale{1};
+  mutable mat4 _transform{1};
+  mutable bool _transformStale{};
+  // neither is copied along with the object
+  SceneGraph *_graph{};
+  int _node{-1};
 };
 
-#endif // TRANSFORMABLE_OBJECT_HPP
\ No newline at end of file
+#endif // TRANSFORMABLE_OBJECT_HPP
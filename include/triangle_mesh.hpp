@@ -2,10 +2,12 @@
 #define TRIANGLE_MESH_HPP
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
-#include "glm.hpp"
+#include "aabb.hpp"
+#include "glm/glm.hpp"
 #include "SharedObject.h"
 
 using namespace glm;
@@ -50,10 +52,23 @@ class TriangleMesh : public cg::SharedObject {
 
   const auto &data() const { return _data; }
 
+  // the box around the vertices, in the mesh's own space
+  const Aabb &localBounds() const { return _localBounds; }
+  // the vertices on the mesh's convex hull, which are all a transformed box
+  // around it depends on; found the first time they are asked for
+  const std::vector<vec3> &hull() const;
+
  private:
+  struct Hull {
+    std::once_flag found;
+    std::vector<vec3> vertices;
+  };
+
   inline static size_t _cubes{}, _planes{}, _customMeshes{};
 
   TriangleMeshData _data;
+  Aabb _localBounds;
+  mutable std::unique_ptr<Hull> _hull{std::make_unique<Hull>()};
 };
 
 #endif  // TRIANGLE_MESH_HPP
\ No newline at end of file
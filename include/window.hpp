@@ -16,7 +16,11 @@
 
 class Window {
 public:
-  Window(size_t width, size_t height, const char *title);
+  // headless windows have no window at all, but for Windows, where a hidden
+  // one needs no display server: their context comes from surfaceless EGL,
+  // without GLFW, and scenes render them offscreen, see Scene::renderHeadless
+  Window(size_t width, size_t height, const char *title,
+         bool headless = false);
 
   ~Window();
 
@@ -29,11 +33,19 @@ public:
   bool keyIsPressed(int key) const;
   std::tuple<float, float> getCursorPos() const;
   void show() const;
+  bool headless() const;
+  // the platform half of ImGui's frame, before ImGui::NewFrame
+  void newUiFrame() const;
 
 private:
+  void _initializeUi();
+
   GLFWwindow *_window{};
   size_t _width, _height;
+  bool _headless;
   ImGuiIO *_imguiIo{};
+  // EGL's display, surface and context, when headless
+  void *_eglDisplay{}, *_eglSurface{}, *_eglContext{};
 };
 
 #endif // GL_BOILERPLATE_HPP
\ No newline at end of file
@@ -31,6 +31,7 @@
 // Last revision: 22/06/2023
 
 #include "BVH.h"
+#include "job_system.hpp"
 #include <algorithm>
 #include <stack>
 
@@ -58,13 +59,14 @@ inline BVHBase::Node *BVHBase::makeLeaf(PrimitiveInfoArray &primitiveInfo,
                                         uint32_t start, uint32_t end,
                                         IndexArray &orderedPrimitiveIds) {
   Bounds3f bounds;
-  auto first = uint32_t(orderedPrimitiveIds.size());
 
+  // leaves come in the order of their ranges, so a leaf's primitives go
+  // where its range starts, whichever subtree gets built first
   for (uint32_t i = start; i < end; ++i) {
     bounds.inflate(primitiveInfo[i].bounds);
-    orderedPrimitiveIds.push_back(_primitiveIds[primitiveInfo[i].index]);
+    orderedPrimitiveIds[i] = _primitiveIds[primitiveInfo[i].index];
   }
-  return new Node{bounds, first, end - start};
+  return new Node{bounds, start, end - start};
 }
 
 inline auto maxDim(const Bounds3f &b) {
@@ -97,8 +99,20 @@ BVHBase::Node *BVHBase::makeNode(PrimitiveInfoArray &primitiveInfo,
                    [dim](const PrimitiveInfo &a, const PrimitiveInfo &b) {
                      return a.centroid[dim] < b.centroid[dim];
                    });
-  return new Node{makeNode(primitiveInfo, start, mid, orderedPrimitiveIds),
-                  makeNode(primitiveInfo, mid, end, orderedPrimitiveIds)};
+  if (end - start < minPrimitivesPerJob)
+    return new Node{makeNode(primitiveInfo, start, mid, orderedPrimitiveIds),
+                    makeNode(primitiveInfo, mid, end, orderedPrimitiveIds)};
+
+  // subtrees cover disjoint ranges, so large ones are built in parallel
+  auto &jobs = JobSystem::instance();
+  Node *left;
+  auto job = jobs.create([&, start, mid] {
+    left = makeNode(primitiveInfo, start, mid, orderedPrimitiveIds);
+  });
+  jobs.run(job);
+  auto right = makeNode(primitiveInfo, mid, end, orderedPrimitiveIds);
+  jobs.wait(job);
+  return new Node{left, right};
 }
 
 BVHBase::~BVHBase() { delete _root; }
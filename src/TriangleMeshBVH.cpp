@@ -41,7 +41,7 @@ namespace cg { // begin namespace cg
 TriangleMeshBVH::TriangleMeshBVH(Actor *actor, PrimitiveArray &&primitives,
                                  uint32_t maxt)
     : BVH{std::move(primitives), maxt}, _actor{actor} {
-  const auto &m = _actor->mesh->data();
+  const auto &m = _actor->mesh()->data();
   auto nt = (uint32_t)m.triangles.size();
 
   assert(nt > 0);
@@ -1,60 +1,99 @@
 #include "actor.hpp"
 
 Actor::Actor(std::string name, const TriangleMesh *mesh)
-    : TransformableObject{std::move(name)}, mesh{mesh} {}
+    : TransformableObject{std::move(name)}, _handle{_registry().create(this)} {
+  _registry().meshes()[slot()] = mesh;
+}
 
 Actor::Actor(std::string name, Material m)
-    : TransformableObject{std::move(name)}, material{m} {}
+    : TransformableObject{std::move(name)}, _handle{_registry().create(this)} {
+  material() = std::move(m);
+}
 
 Actor::Actor(const Actor &other)
-    : TransformableObject{other}, material{other.material} {}
+    : TransformableObject{other},
+      _handle{_registry().create(this)},
+      _boundsMode{other._boundsMode},
+      _isBound{other._isBound} {
+  _copyComponents(other);
+}
 
 Actor::Actor(Actor &&other) noexcept
     : TransformableObject{std::move(other)},
-      material{std::move(other.material)} {}
+      _handle{other._handle},
+      _boundsMode{other._boundsMode},
+      _isBound{other._isBound} {
+  other._handle = {};
+  _registry()._actors[slot()] = this;
+  _moved();
+}
+
+Actor::~Actor() {
+  if (_registry().valid(_handle)) _registry().destroy(_handle);
+}
+
+// children are rebounded by their scene graph once it has placed them, as
+// their world transforms aren't known before that
 
 void Actor::translate(vec3 xyz) {
   this->TransformableObject::translate(xyz);
+  _moved();
+  if (hasParent()) return;
   // no need to rebound when simply translating
-  _boundingBox.a += xyz;
-  _boundingBox.b += xyz;
+  auto &box{_registry().bounds()[slot()]};
+  box.a += xyz;
+  box.b += xyz;
 }
 
 void Actor::rotate(vec3 euler) {
   this->TransformableObject::rotate(euler);
-  bound();
+  _moved();
+  if (!hasParent()) bound();
+}
+
+void Actor::rotate(float angle, vec3 axis) {
+  this->TransformableObject::rotate(angle, axis);
+  _moved();
+  if (!hasParent()) bound();
 }
 
 void Actor::scale(vec3 xyz) {
   this->TransformableObject::scale(xyz);
-  auto center = _boundingBox.center();
-  // an attempt to avoid rebounding when scaling
-  _boundingBox.a = (((_boundingBox.a - center) * abs(xyz)) + center);
-  _boundingBox.b = (((_boundingBox.b - center) * abs(xyz)) + center);
+  _moved();
+  if (!hasParent()) bound();
 }
 
 void Actor::scale(float s) { scale({s, s, s}); }
 
 void Actor::setPosition(vec3 xyz) {
-  _boundingBox.a += xyz - position();
-  _boundingBox.b += xyz - position();
+  auto offset{xyz - position()};
   this->TransformableObject::setPosition(xyz);
+  _moved();
+  if (hasParent()) return;
+  auto &box{_registry().bounds()[slot()]};
+  box.a += offset;
+  box.b += offset;
 }
 
 void Actor::setRotation(vec3 euler) {
   this->TransformableObject::setRotation(euler);
-  bound();
+  _moved();
+  if (!hasParent()) bound();
 }
 
 void Actor::setScale(vec3 xyz) {
   this->TransformableObject::setScale(xyz);
-  bound();
+  _moved();
+  if (!hasParent()) bound();
 }
 
 Actor &Actor::operator=(const Actor &other) {
   if (&other == this) goto skip;
   this->TransformableObject::operator=(other);
-  material = other.material;
+  _copyComponents(other);
+  _boundsMode = other._boundsMode;
+  _isBound = other._isBound;
+  _moved();
 skip:
   return *this;
 }
@@ -62,43 +101,104 @@ skip:
 Actor &Actor::operator=(Actor &&other) noexcept {
   if (&other == this) goto skip;
   this->TransformableObject::operator=(std::move(other));
-  material = std::move(other.material);
+  // trading entities, so that other still has one to be destroyed with
+  std::swap(_handle, other._handle);
+  _registry()._actors[slot()] = this;
+  if (_registry().valid(other._handle))
+    _registry()._actors[other.slot()] = &other;
+  _boundsMode = other._boundsMode;
+  _isBound = other._isBound;
+  _moved();
 skip:
   return *this;
 }
 
-void Actor::bound() {
-  _boundingBox.a = vec3{std::numeric_limits<float>::max()};
-  _boundingBox.b = vec3{std::numeric_limits<float>::lowest()};
-  const auto &meshData{mesh->data()};
-  for (auto &local_v : meshData.vertices) {
-    vec3 v = _transform * vec4{local_v, 1};
-    _boundingBox.a = min(_boundingBox.a, v);
-    _boundingBox.b = max(_boundingBox.b, v);
-  }
+void Actor::bound() { _bound(slot()); }
+
+void Actor::advance(size_t slot, vec3 translation, vec3 euler) {
+  ASSERT(slot == this->slot(), "%s isn't in slot %zu\n", _name.c_str(),
+         slot);
+  this->TransformableObject::translate(translation);
+  this->TransformableObject::rotate(euler);
+  _registry()._moved(slot);
+  if (!hasParent()) _bound(slot);
+}
+
+void Actor::_bound(size_t slot) {
   _isBound = true;
+  auto &registry{_registry()};
+  auto &box{registry.bounds()[slot]};
+  auto mesh{registry.meshes()[slot]};
+  box = {};
+  if (mesh->vertices().empty()) return;
+
+  if (_boundsMode == BoundsMode::tight) {
+    for (auto &v : mesh->hull())
+      box.inflate(vec3{worldTransform() * vec4{v, 1}});
+    return;
+  }
+  // Arvo's method: the box's center is transformed as a point, and its
+  // extent along each world axis sums the local extents, weighted by how much
+  // of each local axis the transform turns onto that world axis
+  auto &local{mesh->localBounds()};
+  auto &m{worldTransform()};
+  vec3 center{m * vec4{local.center(), 1}};
+  auto halfSize{0.5f * local.size()};
+  auto extent{abs(vec3{m[0]}) * halfSize.x + abs(vec3{m[1]}) * halfSize.y +
+              abs(vec3{m[2]}) * halfSize.z};
+  box = {center - extent, center + extent};
+}
+
+bool Actor::isBound() const { return _isBound; }
+
+Aabb Actor::bounds() const { return _registry().bounds()[slot()]; }
+
+void Actor::_worldChanged() {
+  _moved();
+  bound();
+}
+
+void Actor::_moved() { _registry()._moved(slot()); }
+
+void Actor::_copyComponents(const Actor &other) {
+  auto &registry{_registry()};
+  auto from{other.slot()}, to{slot()};
+  registry.bounds()[to] = registry.bounds()[from];
+  registry.bodies()[to] = registry.bodies()[from];
+  registry.materials()[to] = registry.materials()[from];
+  registry.meshes()[to] = registry.meshes()[from];
+  registry.occluders()[to] = registry.occluders()[from];
+}
+
+Actor::BoundsMode Actor::boundsMode() const { return _boundsMode; }
+
+void Actor::setBoundsMode(BoundsMode mode) {
+  _boundsMode = mode;
+  bound();
 }
 
 void Actor::initializeRigidBody(float mass) {
-  this->RigidBody::initializeRigidBody(mass);
-  _centerOfMass = {};
-  const auto &meshData{mesh->data()};
-  if (_inverseMass == 0.0f) {
-    _invInertiaTensor = {};
+  auto &body{this->body()};
+  body.initializeRigidBody(mass);
+  body._centerOfMass = {};
+  const auto &meshData{mesh()->data()};
+  if (body._inverseMass == 0.0f) {
+    body._invInertiaTensor = {};
     for (auto &local_v : meshData.vertices)
-      _centerOfMass += vec3{_transform * vec4{local_v, 1}};
-    _centerOfMass /= float(meshData.vertices.size());
+      body._centerOfMass += vec3{worldTransform() * vec4{local_v, 1}};
+    body._centerOfMass /= float(meshData.vertices.size());
     return;
   }
-  float vertexMass = 1.0f / (float(meshData.vertices.size()) * _inverseMass);
+  float vertexMass =
+      1.0f / (float(meshData.vertices.size()) * body._inverseMass);
   vec3 inertiaTensor{};
   for (auto &local_v : meshData.vertices) {
-    vec3 v{_transform * vec4{local_v, 1}};
+    vec3 v{worldTransform() * vec4{local_v, 1}};
     inertiaTensor.x += vertexMass * (v.y * v.y + v.z * v.z);
     inertiaTensor.y += vertexMass * (v.x * v.x + v.z * v.z);
     inertiaTensor.z += vertexMass * (v.x * v.x + v.y * v.y);
-    _centerOfMass += v;
+    body._centerOfMass += v;
   }
-  _invInertiaTensor = 1.0f / inertiaTensor;
-  _centerOfMass /= float(meshData.vertices.size());
+  body._invInertiaTensor = 1.0f / inertiaTensor;
+  body._centerOfMass /= float(meshData.vertices.size());
 }
\ No newline at end of file
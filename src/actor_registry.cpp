@@ -0,0 +1,75 @@
+#include "actor_registry.hpp"
+
+#include "actor.hpp"
+#include "cpu_profiler.hpp"
+#include "job_system.hpp"
+
+ActorRegistry &ActorRegistry::instance() {
+  static ActorRegistry registry;
+  return registry;
+}
+
+ActorRegistry::Handle ActorRegistry::create(Actor *actor) {
+  uint32_t index;
+  if (_free.empty()) {
+    index = uint32_t(_entries.size());
+    _entries.emplace_back();
+  } else {
+    index = _free.back();
+    _free.pop_back();
+  }
+  auto &entry{_entries[index]};
+  entry.slot = _actors.size();
+  Handle handle{index, entry.generation};
+
+  _handles.push_back(handle);
+  _actors.push_back(actor);
+  _transforms.emplace_back(1);
+  _bounds.emplace_back();
+  _bodies.emplace_back();
+  _materials.emplace_back();
+  _meshes.push_back(nullptr);
+  _proxies.push_back({nullptr, -1});
+  _occluders.push_back(false);
+  _stale.push_back(true);
+  return handle;
+}
+
+void ActorRegistry::destroy(Handle handle) {
+  auto slot{this->slot(handle)};
+  // the last actor moves into the hole, so that the arrays stay dense
+  auto remove{[slot](auto &components) {
+    if (slot + 1 < components.size())
+      components[slot] = std::move(components.back());
+    components.pop_back();
+  }};
+  remove(_handles);
+  remove(_actors);
+  remove(_transforms);
+  remove(_bounds);
+  remove(_bodies);
+  remove(_materials);
+  remove(_meshes);
+  remove(_proxies);
+  remove(_occluders);
+  remove(_stale);
+  if (slot < _handles.size())
+    _entries[_handles[slot].index].slot = slot;
+
+  // handles to the destroyed actor go stale, rather than name whatever
+  // reuses the entry
+  ++_entries[handle.index].generation;
+  _free.push_back(handle.index);
+}
+
+void ActorRegistry::syncTransforms() {
+  PROFILE_ZONE("ActorRegistry::syncTransforms");
+  JobSystem::instance().parallelFor(
+      0, _actors.size(), 1024, [this](size_t first, size_t last) {
+        for (auto i = first; i < last; ++i) {
+          if (!_stale[i]) continue;
+          _transforms[i] = _actors[i]->worldTransform();
+          _stale[i] = false;
+        }
+      });
+}
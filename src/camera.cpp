@@ -5,7 +5,7 @@
 Camera::Camera(std::string name, float fov, float aspect, float near, float far)
     : TransformableObject{name}, _fov{fov}, _aspect{aspect}, _near{near},
       _far{far}, _perspective{glm::perspective(fov, aspect, near, far)},
-      _worldToCamera{glm::inverse(_transform)} {}
+      _worldToCamera{inverseTransform()} {}
 
 Camera::Camera(const Camera &other)
     : TransformableObject{other}, _fov{other._fov}, _aspect{other._aspect},
@@ -88,5 +88,7 @@ void Camera::updatePerspective() {
 }
 
 void Camera::updateWorldToCamera() {
-  _worldToCamera = glm::inverse(_transform);
+  _worldToCamera = inverseWorldTransform();
 }
+
+void Camera::_worldChanged() { updateWorldToCamera(); }
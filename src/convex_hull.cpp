@@ -0,0 +1,213 @@
+#include "convex_hull.hpp"
+
+#include <cfloat>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+#include "cpu_profiler.hpp"
+
+using namespace glm;
+
+namespace {
+
+struct Face {
+  float distance(vec3 p) const { return dot(normal, p) - offset; }
+
+  int v[3];
+  vec3 normal;  // unit, pointing out of the hull
+  float offset;
+  std::vector<int> outside;  // points above the face no other face took
+  bool alive{true};
+  int visited{-1};  // the last step that found the face visible
+};
+
+class QuickHull {
+ public:
+  QuickHull(const std::vector<vec3> &points) : _points{points} {}
+
+  // false if the points have no 3D hull, or rounding got the hull's faces
+  // tangled up
+  bool run();
+  std::vector<vec3> vertices() const;
+
+ private:
+  static uint64_t _key(int a, int b) {
+    return uint64_t(uint32_t(a)) << 32 | uint32_t(b);
+  }
+
+  int _addFace(int a, int b, int c);
+  // the face across the edge from a to b, which runs from b to a there
+  int _neighbor(int a, int b);
+  // adds each point to the outside set of the first face it is above
+  void _assign(const std::vector<int> &points, const std::vector<int> &faces);
+
+  const std::vector<vec3> &_points;
+  float _epsilon{};
+  std::vector<Face> _faces;
+  std::unordered_map<uint64_t, int> _edges;  // directed edge -> its face
+  bool _consistent{true};
+};
+
+int QuickHull::_addFace(int a, int b, int c) {
+  auto &face{_faces.emplace_back()};
+  face.v[0] = a;
+  face.v[1] = b;
+  face.v[2] = c;
+  auto normal{cross(_points[b] - _points[a], _points[c] - _points[a])};
+  auto length{glm::length(normal)};
+  _consistent &= length > 0;
+  face.normal = normal / length;
+  face.offset = dot(face.normal, _points[a]);
+  auto index{int(_faces.size() - 1)};
+  for (int i = 0; i < 3; ++i)
+    _consistent &= _edges.emplace(_key(face.v[i], face.v[(i + 1) % 3]), index)
+                       .second;
+  return index;
+}
+
+int QuickHull::_neighbor(int a, int b) {
+  auto it{_edges.find(_key(b, a))};
+  if (it != _edges.end()) return it->second;
+  _consistent = false;
+  return -1;
+}
+
+void QuickHull::_assign(const std::vector<int> &points,
+                        const std::vector<int> &faces) {
+  for (auto point : points) {
+    for (auto face : faces) {
+      if (_faces[face].distance(_points[point]) > _epsilon) {
+        _faces[face].outside.push_back(point);
+        break;
+      }
+    }
+  }
+}
+
+bool QuickHull::run() {
+  auto count{int(_points.size())};
+  if (count < 4) return false;
+
+  // the extreme points along each axis, and how far from the origin the
+  // points get, which rounding errors scale with
+  int lo[3]{}, hi[3]{};
+  vec3 maxAbs{};
+  for (int i = 0; i < count; ++i) {
+    for (int k = 0; k < 3; ++k) {
+      if (_points[i][k] < _points[lo[k]][k]) lo[k] = i;
+      if (_points[i][k] > _points[hi[k]][k]) hi[k] = i;
+    }
+    maxAbs = max(maxAbs, abs(_points[i]));
+  }
+  _epsilon = 3 * FLT_EPSILON * (maxAbs.x + maxAbs.y + maxAbs.z);
+
+  // the starting tetrahedron: the widest of those pairs, the point farthest
+  // from the line through them, and the one farthest from their plane
+  int axis{};
+  for (int k = 1; k < 3; ++k)
+    if (_points[hi[k]][k] - _points[lo[k]][k] >
+        _points[hi[axis]][axis] - _points[lo[axis]][axis])
+      axis = k;
+  int v0{lo[axis]}, v1{hi[axis]}, v2{-1}, v3{-1};
+  auto direction{normalize(_points[v1] - _points[v0])};
+  float best{_epsilon};
+  for (int i = 0; i < count; ++i) {
+    auto d{_points[i] - _points[v0]};
+    auto distance{length(d - dot(d, direction) * direction)};
+    if (distance > best) best = distance, v2 = i;
+  }
+  if (v2 < 0) return false;
+  auto normal{normalize(
+      cross(_points[v1] - _points[v0], _points[v2] - _points[v0]))};
+  best = _epsilon;
+  for (int i = 0; i < count; ++i) {
+    auto distance{std::abs(dot(normal, _points[i] - _points[v0]))};
+    if (distance > best) best = distance, v3 = i;
+  }
+  if (v3 < 0) return false;
+
+  // faces wound so that the vertex they leave out is below them
+  int tetrahedron[4][4]{
+      {v0, v1, v2, v3}, {v0, v3, v1, v2}, {v0, v2, v3, v1}, {v1, v3, v2, v0}};
+  for (auto &[a, b, c, opposite] : tetrahedron) {
+    auto n{cross(_points[b] - _points[a], _points[c] - _points[a])};
+    if (dot(n, _points[opposite] - _points[a]) > 0) std::swap(b, c);
+    _addFace(a, b, c);
+  }
+  std::vector<int> points(count);
+  for (int i = 0; i < count; ++i) points[i] = i;
+  _assign(points, {0, 1, 2, 3});
+
+  // every face is either on the hull or removed by the first point found
+  // above it, so faces only need to be visited in the order they are made
+  std::vector<int> visible, newFaces, orphans;
+  std::vector<std::pair<int, int>> horizon;
+  for (int f = 0; f < int(_faces.size()) && _consistent; ++f) {
+    if (!_faces[f].alive || _faces[f].outside.empty()) continue;
+
+    int eye{};
+    float farthest{-FLT_MAX};
+    for (auto point : _faces[f].outside) {
+      auto distance{_faces[f].distance(_points[point])};
+      if (distance > farthest) farthest = distance, eye = point;
+    }
+
+    // the faces the eye sees, and the loop of edges around them
+    visible.assign(1, f);
+    horizon.clear();
+    _faces[f].visited = f;
+    for (size_t i = 0; i < visible.size() && _consistent; ++i) {
+      auto &v{_faces[visible[i]].v};
+      for (int e = 0; e < 3; ++e) {
+        auto a{v[e]}, b{v[(e + 1) % 3]};
+        auto neighbor{_neighbor(a, b)};
+        if (neighbor < 0 || _faces[neighbor].visited == f) continue;
+        if (_faces[neighbor].distance(_points[eye]) > _epsilon) {
+          _faces[neighbor].visited = f;
+          visible.push_back(neighbor);
+        } else {
+          horizon.emplace_back(a, b);
+        }
+      }
+    }
+
+    orphans.clear();
+    for (auto index : visible) {
+      auto &face{_faces[index]};
+      face.alive = false;
+      for (auto point : face.outside)
+        if (point != eye) orphans.push_back(point);
+      face.outside = {};
+      for (int e = 0; e < 3; ++e)
+        _edges.erase(_key(face.v[e], face.v[(e + 1) % 3]));
+    }
+    newFaces.clear();
+    for (auto [a, b] : horizon) newFaces.push_back(_addFace(a, b, eye));
+    _assign(orphans, newFaces);
+  }
+  return _consistent;
+}
+
+std::vector<vec3> QuickHull::vertices() const {
+  std::vector<bool> used(_points.size());
+  std::vector<vec3> vertices;
+  for (auto &face : _faces) {
+    if (!face.alive) continue;
+    for (auto v : face.v) {
+      if (used[v]) continue;
+      used[v] = true;
+      vertices.push_back(_points[v]);
+    }
+  }
+  return vertices;
+}
+
+}  // namespace
+
+std::vector<vec3> convexHullVertices(const std::vector<vec3> &points) {
+  PROFILE_ZONE("convexHullVertices");
+  QuickHull hull{points};
+  if (!hull.run()) return points;
+  return hull.vertices();
+}
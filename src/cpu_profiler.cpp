@@ -0,0 +1,125 @@
+#include "cpu_profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// zones recorded by a single thread, written by it alone and read by anyone
+struct ThreadBuffer {
+  uint32_t thread;
+  std::unique_ptr<CpuProfiler::Zone[]> zones{
+      new CpuProfiler::Zone[CpuProfiler::bufferSize]};
+  // zones ever recorded, the last bufferSize of which are kept
+  std::atomic<uint64_t> written{};
+};
+
+}  // namespace
+
+// guards the list of buffers, not what is in them
+static std::mutex buffersMutex;
+// buffers outlive their threads, so that what they recorded can be exported
+static std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+static std::atomic<int64_t> lastFrameStart{}, lastFrameEnd{};
+
+static ThreadBuffer &localBuffer() {
+  thread_local ThreadBuffer *buffer{[] {
+    std::lock_guard lock{buffersMutex};
+    auto &added{buffers.emplace_back(std::make_unique<ThreadBuffer>())};
+    added->thread = uint32_t(buffers.size() - 1);
+    return added.get();
+  }()};
+  return *buffer;
+}
+
+int64_t CpuProfiler::now() {
+  using namespace std::chrono;
+  static const auto epoch{steady_clock::now()};
+  return duration_cast<nanoseconds>(steady_clock::now() - epoch).count();
+}
+
+void CpuProfiler::record(const Zone &zone) {
+  auto &buffer{localBuffer()};
+  auto count{buffer.written.load(std::memory_order_relaxed)};
+  buffer.zones[count % bufferSize] = zone;
+  // readers only look at zones written before the count they see
+  buffer.written.store(count + 1, std::memory_order_release);
+}
+
+uint32_t &CpuProfiler::depth() {
+  thread_local uint32_t depth{};
+  return depth;
+}
+
+void CpuProfiler::markFrame() {
+  lastFrameStart = lastFrameEnd.exchange(now());
+}
+
+int64_t CpuProfiler::frameStart() { return lastFrameStart; }
+
+int64_t CpuProfiler::frameEnd() { return lastFrameEnd; }
+
+void CpuProfiler::collect(int64_t start, int64_t end,
+                          std::vector<ThreadZone> &zones) {
+  zones.clear();
+  std::vector<ThreadBuffer *> snapshot;
+  {
+    std::lock_guard lock{buffersMutex};
+    for (auto &buffer : buffers) snapshot.push_back(buffer.get());
+  }
+
+  std::vector<Zone> copy;
+  for (auto buffer : snapshot) {
+    // zones are recorded as they end, so going from the newest back, those
+    // ending before start, and all older ones, are of no interest
+    auto written{buffer->written.load(std::memory_order_acquire)};
+    auto first{written > bufferSize ? written - bufferSize : 0};
+    copy.clear();
+    for (auto i = written; i > first; --i) {
+      auto &zone{buffer->zones[(i - 1) % bufferSize]};
+      if (zone.end < start) break;
+      copy.push_back(zone);
+    }
+
+    // the thread kept recording meanwhile; zones it overwrote, or was about
+    // to, may be torn and are dropped
+    auto writtenAfter{buffer->written.load(std::memory_order_acquire)};
+    auto valid{writtenAfter + 1 > bufferSize ? writtenAfter + 1 - bufferSize
+                                             : uint64_t{}};
+    auto count{
+        std::min<uint64_t>(copy.size(), written - std::min(valid, written))};
+    for (auto i = count; i > 0; --i) {
+      auto &zone{copy[i - 1]};
+      if (start <= zone.start && zone.start < end)
+        zones.push_back({buffer->thread, zone});
+    }
+  }
+}
+
+bool CpuProfiler::exportChromeTrace(const std::string &file) {
+  std::vector<ThreadZone> zones;
+  collect(std::numeric_limits<int64_t>::min(),
+          std::numeric_limits<int64_t>::max(), zones);
+
+  std::ofstream os{file};
+  os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  for (size_t i = 0; i < zones.size(); ++i) {
+    auto &[thread, zone]{zones[i]};
+    os << (i ? "," : "") << "\n  {\"name\": \"";
+    for (auto c{zone.name}; *c; ++c) {
+      if (*c == '"' || *c == '\\') os << '\\';
+      os << *c;
+    }
+    // complete events, in microseconds
+    os << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << thread
+       << ", \"ts\": " << 1e-3 * double(zone.start)
+       << ", \"dur\": " << 1e-3 * double(zone.end - zone.start) << "}";
+  }
+  os << "\n]}\n";
+  return bool(os);
+}
@@ -0,0 +1,111 @@
+#include "dbvh.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstdio>
+
+#include "cpu_profiler.hpp"
+#include "job_system.hpp"
+#include "morton.hpp"
+#include "radix_sort.hpp"
+
+namespace {
+
+// half the surface area of the box around both a and b
+float unionArea(const Aabb &a, const Aabb &b) {
+  auto size{glm::max(a.b, b.b) - glm::min(a.a, b.a)};
+  return size.x * size.y + size.x * size.z + size.y * size.z;
+}
+
+struct SortedLeaf {
+  uint64_t code;
+  int node;
+};
+
+}  // namespace
+
+DynamicBoundingVolumeHierarchy::DynamicBoundingVolumeHierarchy(
+    const std::vector<Actor *> &actors) {
+  PROFILE_ZONE("DBVH::DBVH");
+  auto leafCount{int(actors.size())};
+  if (leafCount == 0) return;
+  // a binary tree over n leaves has n - 1 inner nodes, so node references
+  // stay valid while merging
+  _nodes.reserve(2 * size_t(leafCount) - 1);
+
+  Aabb centers;
+  for (auto actor : actors) {
+    auto &leaf{_nodes.emplace_back()};
+    leaf.aabb = actor->bounds();
+    leaf.object = actor;
+    centers.inflate(leaf.aabb.center());
+  }
+
+  std::vector<SortedLeaf> sorted(leafCount), scratch;
+  for (int i = 0; i < leafCount; ++i)
+    sorted[i] = {mortonEncode(_nodes[i].aabb.center(), centers), i};
+  radixSort(sorted, scratch, [](const SortedLeaf &leaf) { return leaf.code; });
+
+  // the roots of the subtrees built so far, in Morton order
+  std::vector<int> clusters(leafCount), neighbors, next;
+  for (int i = 0; i < leafCount; ++i) clusters[i] = sorted[i].node;
+
+  auto &jobs{JobSystem::instance()};
+  while (clusters.size() > 1) {
+    auto count{int(clusters.size())};
+    neighbors.resize(count);
+    jobs.parallelFor(0, count, 1024, [&](size_t first, size_t last) {
+      for (auto i = int(first); i < int(last); ++i) {
+        auto &aabb{_nodes[clusters[i]].aabb};
+        auto bestArea{FLT_MAX};
+        int best{};
+        // the scan goes left to right and only takes strictly smaller areas,
+        // so ties go to the pair that comes first; with every cluster ranking
+        // pairs the same way, the best pair overall always picks each other,
+        // and every pass merges something
+        auto end{std::min(i + searchRadius, count - 1)};
+        for (auto j = std::max(i - searchRadius, 0); j <= end; ++j) {
+          if (j == i) continue;
+          auto area{unionArea(aabb, _nodes[clusters[j]].aabb)};
+          if (area < bestArea) {
+            bestArea = area;
+            best = j;
+          }
+        }
+        neighbors[i] = best;
+      }
+    });
+
+    // merged clusters take the place of the first of the pair, which keeps
+    // the list in Morton order
+    next.clear();
+    for (int i = 0; i < count; ++i) {
+      auto j{neighbors[i]};
+      if (neighbors[j] != i) {
+        next.push_back(clusters[i]);
+      } else if (i < j) {
+        auto index{int(_nodes.size())};
+        auto &left{_nodes[clusters[i]]}, &right{_nodes[clusters[j]]};
+        auto &parent{_nodes.emplace_back()};
+        parent.aabb = left.aabb;
+        parent.aabb.inflate(right.aabb);
+        parent.left = clusters[i];
+        parent.right = clusters[j];
+        left.parent = right.parent = index;
+        next.push_back(index);
+      }
+    }
+    clusters.swap(next);
+  }
+  _root = clusters[0];
+}
+
+void DynamicBoundingVolumeHierarchy::debugPrint() const {
+  visit([](int, const Node &node) {
+    printf("[(%f %f %f), (%f %f %f)]", node.aabb.a.x, node.aabb.a.y,
+           node.aabb.a.z, node.aabb.b.x, node.aabb.b.y, node.aabb.b.z);
+    if (node.object) printf("%s", node.object->name().c_str());
+    puts("");
+  });
+}
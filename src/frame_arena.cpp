@@ -0,0 +1,42 @@
+#include "frame_arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(size_t capacity)
+    : _memory{new std::byte[capacity]}, _capacity{capacity} {}
+
+void *FrameArena::allocate(size_t size, size_t alignment) {
+  auto base{reinterpret_cast<uintptr_t>(_memory.get())};
+  auto offset{_offset.load(std::memory_order_relaxed)};
+  size_t start;
+  do {
+    start = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+    if (start + size > _capacity) return _allocateOverflow(size, alignment);
+  } while (!_offset.compare_exchange_weak(offset, start + size,
+                                          std::memory_order_relaxed));
+  return _memory.get() + start;
+}
+
+void *FrameArena::_allocateOverflow(size_t size, size_t alignment) {
+  auto padded{size + alignment - 1};
+  _overflowSize.fetch_add(padded, std::memory_order_relaxed);
+  std::lock_guard lock{_overflowMutex};
+  void *block{_overflow.emplace_back(new std::byte[padded]).get()};
+  return std::align(alignment, size, block, padded);
+}
+
+void FrameArena::reset() {
+  if (!_overflow.empty()) {
+    // at least doubling, so that frames growing steadily settle quickly
+    _capacity = std::max(2 * _capacity, used());
+    _memory.reset(new std::byte[_capacity]);
+    _overflow.clear();
+    _overflowSize = 0;
+  }
+  _offset = 0;
+}
+
+size_t FrameArena::capacity() const { return _capacity; }
+
+size_t FrameArena::used() const { return _offset + _overflowSize; }
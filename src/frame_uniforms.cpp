@@ -0,0 +1,21 @@
+#include "frame_uniforms.hpp"
+
+#include "gl_util.hpp"
+
+FrameUniformBuffer::FrameUniformBuffer() {
+  glCheck(glGenBuffers(1, &_buffer));
+  glCheck(glBindBuffer(GL_UNIFORM_BUFFER, _buffer));
+  glCheck(glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr,
+                       GL_DYNAMIC_DRAW));
+}
+
+FrameUniformBuffer::~FrameUniformBuffer() {
+  glCheck(glDeleteBuffers(1, &_buffer));
+}
+
+void FrameUniformBuffer::update(const FrameUniforms &uniforms) {
+  glCheck(glBindBuffer(GL_UNIFORM_BUFFER, _buffer));
+  glCheck(glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms),
+                          &uniforms));
+  glCheck(glBindBufferBase(GL_UNIFORM_BUFFER, 0, _buffer));
+}
@@ -0,0 +1,79 @@
+#include "frustum_culler.hpp"
+
+#include "cpu_profiler.hpp"
+
+static bool contains(const Aabb &outer, const Aabb &inner) {
+  return all(lessThanEqual(outer.a, inner.a)) &&
+         all(greaterThanEqual(outer.b, inner.b));
+}
+
+void FrustumCuller::add(Actor *actor) {
+  if (!actor->isBound()) actor->bound();
+  auto [it, isNew]{_leaves.try_emplace(actor)};
+  if (isNew) it->second = _tree.add(_fatten(actor->bounds()), actor);
+}
+
+void FrustumCuller::remove(const Actor *actor) {
+  if (auto it{_leaves.find(actor)}; it != _leaves.end()) {
+    _tree.remove(it->second);
+    _leaves.erase(it);
+  }
+}
+
+void FrustumCuller::refit() {
+  for (auto [actor, leaf] : _leaves) {
+    auto bounds{actor->bounds()};
+    if (!contains(_tree.get(leaf).bounds(), bounds))
+      _tree.update(leaf, _fatten(bounds));
+  }
+}
+
+void FrustumCuller::cull(const Frustum &frustum,
+                         std::vector<const Actor *> &visible) const {
+  PROFILE_ZONE("FrustumCuller::cull");
+  visible.clear();
+  if (_tree.root() == cg::DynamicTreeNode::null) return;
+
+  // the tree is balanced, so it is never nearly this deep
+  int stack[64];
+  int top{};
+  stack[top++] = _tree.root();
+  while (top) {
+    auto index{stack[--top]};
+    auto node{_tree.getNode(index)};
+    switch (frustum.classify(node->bounds)) {
+      case Frustum::Containment::outside:
+        break;
+      case Frustum::Containment::inside:
+        // early accept, no need to test anything below
+        _collect(_tree, index, visible);
+        break;
+      case Frustum::Containment::intersecting:
+        if (node->isLeaf()) {
+          visible.push_back((const Actor *)node->userData);
+        } else {
+          stack[top++] = node->children[0];
+          stack[top++] = node->children[1];
+        }
+        break;
+    }
+  }
+}
+
+size_t FrustumCuller::actorCount() const { return _leaves.size(); }
+
+Aabb FrustumCuller::_fatten(const Aabb &bounds) {
+  auto margin{_margin * bounds.size() + 1e-3f};
+  return {bounds.a - margin, bounds.b + margin};
+}
+
+void FrustumCuller::_collect(const cg::DynamicTree &tree, int index,
+                             std::vector<const Actor *> &visible) {
+  auto node{tree.getNode(index)};
+  if (node->isLeaf()) {
+    visible.push_back((const Actor *)node->userData);
+    return;
+  }
+  _collect(tree, node->children[0], visible);
+  _collect(tree, node->children[1], visible);
+}
@@ -0,0 +1,79 @@
+#include "g_buffer.hpp"
+
+#include "custom_assert.hpp"
+#include "gl_util.hpp"
+
+// normals are signed and Ns, kept in the normal's alpha, goes well beyond 1,
+// as may Ks
+static constexpr GLenum formats[GBuffer::targetCount]{GL_RGBA16F, GL_RGBA8,
+                                                      GL_RGBA16F, GL_RGBA8};
+
+GBuffer::GBuffer() {
+  glCheck(glGenFramebuffers(1, &_framebuffer));
+  glCheck(glGenTextures(targetCount, _targets));
+  glCheck(glGenTextures(1, &_depth));
+}
+
+GBuffer::~GBuffer() {
+  glCheck(glDeleteFramebuffers(1, &_framebuffer));
+  glCheck(glDeleteTextures(targetCount, _targets));
+  glCheck(glDeleteTextures(1, &_depth));
+}
+
+void GBuffer::resize(GLsizei width, GLsizei height) {
+  if (width == _width && height == _height) return;
+  _width = width;
+  _height = height;
+
+  auto allocate{[&](GLuint texture, GLenum internalFormat, GLenum format,
+                    GLenum type) {
+    glCheck(glBindTexture(GL_TEXTURE_2D, texture));
+    glCheck(glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0,
+                         format, type, nullptr));
+    glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+  }};
+
+  glCheck(glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer));
+  GLenum attachments[targetCount];
+  for (int i = 0; i < targetCount; ++i) {
+    allocate(_targets[i], formats[i], GL_RGBA, GL_FLOAT);
+    attachments[i] = GL_COLOR_ATTACHMENT0 + i;
+    glCheck(glFramebufferTexture2D(GL_FRAMEBUFFER, attachments[i],
+                                   GL_TEXTURE_2D, _targets[i], 0));
+  }
+  // same format as the default framebuffer's, which blitting requires
+  allocate(_depth, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL,
+           GL_UNSIGNED_INT_24_8);
+  glCheck(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                                 GL_TEXTURE_2D, _depth, 0));
+  glCheck(glDrawBuffers(targetCount, attachments));
+
+  GLenum status;
+  glCheck(status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+  ASSERT(status == GL_FRAMEBUFFER_COMPLETE, "G-buffer incomplete: 0x%x",
+         status);
+  glCheck(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void GBuffer::bind() const {
+  glCheck(glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer));
+}
+
+void GBuffer::bindTextures(GLuint firstUnit) const {
+  for (GLuint i = 0; i < targetCount; ++i) {
+    glCheck(glActiveTexture(GL_TEXTURE0 + firstUnit + i));
+    glCheck(glBindTexture(GL_TEXTURE_2D, _targets[i]));
+  }
+  glCheck(glActiveTexture(GL_TEXTURE0 + firstUnit + targetCount));
+  glCheck(glBindTexture(GL_TEXTURE_2D, _depth));
+  glCheck(glActiveTexture(GL_TEXTURE0));
+}
+
+void GBuffer::blitDepth(GLuint target) const {
+  glCheck(glBindFramebuffer(GL_READ_FRAMEBUFFER, _framebuffer));
+  glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target));
+  glCheck(glBlitFramebuffer(0, 0, _width, _height, 0, 0, _width, _height,
+                            GL_DEPTH_BUFFER_BIT, GL_NEAREST));
+  glCheck(glBindFramebuffer(GL_FRAMEBUFFER, target));
+}
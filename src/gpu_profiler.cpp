@@ -0,0 +1,114 @@
+#include "gpu_profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#include "gl_util.hpp"
+
+GpuProfiler::~GpuProfiler() {
+  for (auto &frame : _frames)
+    if (!frame.queries.empty())
+      glCheck(glDeleteQueries(GLsizei(frame.queries.size()),
+                              frame.queries.data()));
+}
+
+void GpuProfiler::beginFrame() {
+  // the queries about to be reused were issued latency frames ago
+  auto &frame{_frames[_current]};
+  _collect(frame);
+  frame.index = _frameIndex++;
+}
+
+void GpuProfiler::endFrame() { _current = (_current + 1) % latency; }
+
+void GpuProfiler::flush() {
+  // oldest first, the current frame being the next to be reused
+  for (unsigned i = 0; i < latency; ++i)
+    _collect(_frames[(_current + i) % latency]);
+}
+
+void GpuProfiler::_collect(Frame &frame) {
+  _frameMs.assign(_passes.size(), -1);
+  for (size_t i = 0; i < frame.used; ++i) {
+    GLuint64 ns{};
+    glCheck(glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &ns));
+    auto &ms{_frameMs[frame.passes[i]]};
+    ms = std::max(ms, 0.0) + 1e-6 * double(ns);
+  }
+  for (size_t i = 0; i < _passes.size(); ++i) {
+    if (_frameMs[i] < 0) continue;
+    auto &pass{_passes[i]};
+    if (pass.ms.size() < historySize) {
+      pass.frames.push_back(frame.index);
+      pass.ms.push_back(_frameMs[i]);
+    } else {
+      pass.frames[pass.next] = frame.index;
+      pass.ms[pass.next] = _frameMs[i];
+    }
+    pass.next = (pass.next + 1) % historySize;
+  }
+
+  frame.passes.clear();
+  frame.used = 0;
+}
+
+void GpuProfiler::begin(const char *pass) {
+  auto it{std::find_if(_passes.begin(), _passes.end(),
+                       [&](const Pass &p) { return p.name == pass; })};
+  if (it == _passes.end()) it = _passes.insert(it, Pass{pass, {}, {}, 0});
+
+  auto &frame{_frames[_current]};
+  if (frame.used == frame.queries.size()) {
+    frame.queries.push_back(0);
+    glCheck(glGenQueries(1, &frame.queries.back()));
+  }
+  frame.passes.push_back(size_t(it - _passes.begin()));
+  glCheck(glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.used++]));
+}
+
+void GpuProfiler::end() { glCheck(glEndQuery(GL_TIME_ELAPSED)); }
+
+size_t GpuProfiler::passCount() const { return _passes.size(); }
+
+const std::string &GpuProfiler::passName(size_t pass) const {
+  return _passes[pass].name;
+}
+
+GpuProfiler::Stats GpuProfiler::stats(size_t pass) const {
+  auto ms{_passes[pass].ms};
+  if (ms.empty()) return {};
+
+  Stats stats{};
+  for (auto sample : ms) stats.average += sample;
+  stats.average /= double(ms.size());
+  auto percentile{[&](double p) {
+    auto nth{ms.begin() + ptrdiff_t(p * double(ms.size() - 1))};
+    std::nth_element(ms.begin(), nth, ms.end());
+    return *nth;
+  }};
+  stats.p50 = percentile(0.50);
+  stats.p95 = percentile(0.95);
+  stats.p99 = percentile(0.99);
+  return stats;
+}
+
+bool GpuProfiler::exportCsv(const std::string &file) const {
+  struct Row {
+    uint64_t frame;
+    size_t pass;
+    double ms;
+  };
+  std::vector<Row> rows;
+  for (size_t i = 0; i < _passes.size(); ++i)
+    for (size_t j = 0; j < _passes[i].ms.size(); ++j)
+      rows.push_back({_passes[i].frames[j], i, _passes[i].ms[j]});
+  std::stable_sort(rows.begin(), rows.end(), [](auto &a, auto &b) {
+    return a.frame < b.frame || (a.frame == b.frame && a.pass < b.pass);
+  });
+
+  std::ofstream os{file};
+  os << "frame,pass,ms\n";
+  for (auto &row : rows)
+    os << row.frame << ',' << _passes[row.pass].name << ',' << row.ms << '\n';
+  return bool(os);
+}
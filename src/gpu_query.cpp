@@ -0,0 +1,29 @@
+#include "gpu_query.hpp"
+
+#include "gl_util.hpp"
+
+GpuQuery::GpuQuery(GLenum target) : _target{target} {
+  glCheck(glGenQueries(latency, _queries));
+}
+
+GpuQuery::~GpuQuery() { glCheck(glDeleteQueries(latency, _queries)); }
+
+void GpuQuery::begin() {
+  // the query about to be reused was issued latency frames ago
+  auto query{_queries[_current]};
+  if (_pending[_current]) {
+    GLuint64 result{};
+    glCheck(glGetQueryObjectui64v(query, GL_QUERY_RESULT, &result));
+    _average = _average == 0 ? double(result)
+                             : 0.95 * _average + 0.05 * double(result);
+  }
+  glCheck(glBeginQuery(_target, query));
+}
+
+void GpuQuery::end() {
+  glCheck(glEndQuery(_target));
+  _pending[_current] = true;
+  _current = (_current + 1) % latency;
+}
+
+double GpuQuery::average() const { return _average; }
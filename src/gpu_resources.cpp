@@ -0,0 +1,96 @@
+#include "gpu_resources.hpp"
+
+#include "custom_assert.hpp"
+#include "gl_util.hpp"
+#include "log.hpp"
+#include "ppm.hpp"
+
+// mesh data goes away with the arena
+GpuResources::~GpuResources() {
+  for (auto &[file, entry] : _textures)
+    glCheck(glDeleteTextures(1, &entry.texture));
+}
+
+void GpuResources::acquire(const Actor *actor) {
+  auto [resident, isNewResident]{_residents.try_emplace(actor)};
+  if (!isNewResident) return;
+  resident->second = {actor->mesh(), actor->material().map_Kd};
+
+  auto [mesh, isNewMesh]{_meshes.try_emplace(actor->mesh())};
+  if (isNewMesh) mesh->second.allocation = _arena.allocate(actor->mesh());
+  ++mesh->second.references;
+
+  if (auto &file{actor->material().map_Kd}; !file.empty()) {
+    auto [texture, isNewTexture]{_textures.try_emplace(file)};
+    if (isNewTexture) {
+      glCheck(glGenTextures(1, &texture->second.texture));
+      upload(texture->second.texture, file);
+    }
+    ++texture->second.references;
+  }
+}
+
+void GpuResources::release(const Actor *actor) {
+  auto resident{_residents.find(actor)};
+  if (resident == _residents.end()) return;
+  auto &[meshPtr, file]{resident->second};
+
+  auto mesh{_meshes.find(meshPtr)};
+  if (--mesh->second.references == 0) {
+    _arena.free(mesh->second.allocation);
+    _meshes.erase(mesh);
+  }
+
+  if (!file.empty()) {
+    auto texture{_textures.find(file)};
+    if (--texture->second.references == 0) {
+      glCheck(glDeleteTextures(1, &texture->second.texture));
+      _textures.erase(texture);
+    }
+  }
+
+  _residents.erase(resident);
+}
+
+const GpuResources::Mesh &GpuResources::mesh(const TriangleMesh *mesh) const {
+  auto it{_meshes.find(mesh)};
+  ASSERT(it != _meshes.end(), "mesh %p is not resident\n", (const void *)mesh);
+  return it->second.allocation;
+}
+
+GLuint GpuResources::texture(const std::string &file) const {
+  auto it{_textures.find(file)};
+  ASSERT(it != _textures.end(), "texture %s is not resident\n", file.c_str());
+  return it->second.texture;
+}
+
+const MeshArena &GpuResources::arena() const { return _arena; }
+
+size_t GpuResources::meshCount() const { return _meshes.size(); }
+
+size_t GpuResources::textureCount() const { return _textures.size(); }
+
+void GpuResources::upload(GLuint texture, const std::string &file) {
+  logMsg("[INFO] Uploading texture %s\n", file.c_str());
+  PPM bah{file};
+  glCheck(glBindTexture(GL_TEXTURE_2D, texture));
+  glCheck(
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT));
+  glCheck(
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT));
+  glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+  glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+  glCheck(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+  glCheck(glTexImage2D(  //
+      GL_TEXTURE_2D,     // target
+      0,                 // level
+      GL_RGB,            // internalformat
+      bah.width(),       // width
+      bah.height(),      // height
+      0,                 // border
+      GL_RGB,            // format
+      GL_UNSIGNED_BYTE,  // type
+      bah.pixels()       // data
+      ));
+  glCheck(glGenerateMipmap(GL_TEXTURE_2D));
+}
@@ -0,0 +1,44 @@
+#include "instancing.hpp"
+
+#include "cpu_profiler.hpp"
+#include "gl_util.hpp"
+
+void InstanceBatcher::upload(const RenderQueue &queue) {
+  PROFILE_ZONE("InstanceBatcher::upload");
+  auto &items{queue.items()};
+  _batches.clear();
+
+  // written in place, the GPU reads straight from the mapped section
+  auto instances{(InstanceData *)_ring.begin(items.size())};
+  // transforms as of the frame's ActorRegistry::syncTransforms()
+  auto &registry{ActorRegistry::instance()};
+  auto transforms{registry.transforms()};
+  auto materials{registry.materials()};
+  for (GLuint i = 0; i < items.size(); ++i) {
+    auto state{RenderQueue::stateOf(items[i].key)};
+    auto actor{items[i].actor};
+    if (i == 0 || state != RenderQueue::stateOf(items[i - 1].key))
+      _batches.push_back({RenderQueue::passOf(items[i].key), actor->mesh(),
+                          &actor->material().map_Kd, i, 0});
+    ++_batches.back().instanceCount;
+
+    auto slot{actor->slot()};
+    auto &m{materials[slot]};
+    instances[i] = {transforms[slot], vec4{m.Ka, m.Ns}, vec4{m.Kd, m.Ni},
+                    vec4{m.Ks, m.d}};
+  }
+}
+
+void InstanceBatcher::bind() const {
+  glCheck(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _ring.buffer()));
+}
+
+GLuint InstanceBatcher::firstObject() const { return _ring.first(); }
+
+void InstanceBatcher::endFrame() { _ring.end(); }
+
+size_t InstanceBatcher::bytesStreamed() const { return _ring.bytesStreamed(); }
+
+const std::vector<InstanceBatcher::Batch> &InstanceBatcher::batches() const {
+  return _batches;
+}
@@ -0,0 +1,237 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+
+#include "custom_assert.hpp"
+
+// Chase-Lev deque of fixed size, in the formulation of Lê et al. for weak
+// memory models. Only its owner pushes and pops, at the bottom; anyone steals,
+// at the top.
+class JobSystem::Deque {
+ public:
+  bool push(Job *job) {
+    auto bottom{_bottom.load(std::memory_order_relaxed)};
+    auto top{_top.load(std::memory_order_acquire)};
+    if (bottom - top >= int64_t(dequeSize)) return false;
+    _jobs[bottom & (dequeSize - 1)].store(job, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+    _bottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  Job *pop() {
+    auto bottom{_bottom.load(std::memory_order_relaxed) - 1};
+    _bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top{_top.load(std::memory_order_relaxed)};
+    if (top > bottom) {
+      _bottom.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    auto job{_jobs[bottom & (dequeSize - 1)].load(std::memory_order_acquire)};
+    if (top == bottom) {
+      // the last job left, which a thief may be taking as well
+      if (!_top.compare_exchange_strong(top, top + 1,
+                                        std::memory_order_seq_cst,
+                                        std::memory_order_relaxed))
+        job = nullptr;
+      _bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+  }
+
+  Job *steal() {
+    auto top{_top.load(std::memory_order_acquire)};
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto bottom{_bottom.load(std::memory_order_acquire)};
+    if (top >= bottom) return nullptr;
+    auto job{_jobs[top & (dequeSize - 1)].load(std::memory_order_acquire)};
+    if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed))
+      return nullptr;
+    return job;
+  }
+
+ private:
+  static_assert((dequeSize & (dequeSize - 1)) == 0,
+                "deque size must be a power of two");
+
+  alignas(64) std::atomic<int64_t> _top{};
+  alignas(64) std::atomic<int64_t> _bottom{};
+  std::unique_ptr<std::atomic<Job *>[]> _jobs{
+      new std::atomic<Job *>[dequeSize]};
+};
+
+struct JobSystem::Worker {
+  unsigned index;
+  Deque deque;
+  std::unique_ptr<Job[]> jobs{new Job[jobsPerThread]};
+  size_t nextJob{};
+  uint32_t random;  // state of the xorshift picking victims to steal from
+  alignas(64) std::atomic<uint64_t> executed{}, stolen{};
+};
+
+thread_local JobSystem::Worker *JobSystem::_current{};
+
+JobSystem &JobSystem::instance() {
+  static JobSystem system;
+  return system;
+}
+
+unsigned JobSystem::defaultWorkerCount() {
+  return std::max(std::thread::hardware_concurrency(), 1u) - 1;
+}
+
+JobSystem::JobSystem(unsigned workerCount) {
+  for (unsigned i = 0; i <= workerCount; ++i) {
+    _workers.push_back(std::make_unique<Worker>());
+    _workers.back()->index = i;
+    _workers.back()->random = 2654435761u * (i + 1);
+    for (size_t j = 0; j < jobsPerThread; ++j)
+      _workers.back()->jobs[j].unfinished.store(0, std::memory_order_relaxed);
+  }
+  _current = _workers[0].get();
+  for (unsigned i = 1; i <= workerCount; ++i)
+    _threads.emplace_back(&JobSystem::_work, this, i);
+}
+
+JobSystem::~JobSystem() {
+  _stop = true;
+  _epoch.fetch_add(1);
+  _epoch.notify_all();
+  for (auto &thread : _threads) thread.join();
+  if (_current == _workers[0].get()) _current = nullptr;
+}
+
+unsigned JobSystem::threadCount() const { return unsigned(_workers.size()); }
+
+JobSystem::Stats JobSystem::stats() const {
+  Stats stats{};
+  for (auto &worker : _workers) {
+    stats.executed += worker->executed.load(std::memory_order_relaxed);
+    stats.stolen += worker->stolen.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+JobSystem::Worker &JobSystem::_local() {
+  ASSERT(_current && _workers[_current->index].get() == _current,
+         "jobs used outside the %u threads of the job system", threadCount());
+  return *_current;
+}
+
+JobSystem::Job *JobSystem::_allocate() {
+  auto &worker{_local()};
+  // slots of jobs still unfinished, waited on for long, are skipped
+  for (size_t i = 0; i < jobsPerThread; ++i) {
+    auto &job{worker.jobs[worker.nextJob++ % jobsPerThread]};
+    if (job.unfinished.load(std::memory_order_acquire) == 0) return &job;
+  }
+  ASSERT(false, "more than %zu unfinished jobs on a thread", jobsPerThread);
+  return nullptr;
+}
+
+void JobSystem::addDependency(Job *job, Job *prerequisite) {
+  ASSERT(prerequisite->dependentCount < maxDependents,
+         "a job can't have more than %zu dependents", maxDependents);
+  ASSERT(prerequisite->blockers.load(std::memory_order_relaxed) > 0 &&
+             job->blockers.load(std::memory_order_relaxed) > 0,
+         "job %p or %p already run", (void *)job, (void *)prerequisite);
+  job->blockers.fetch_add(1, std::memory_order_relaxed);
+  prerequisite->dependents[prerequisite->dependentCount++] = job;
+}
+
+void JobSystem::run(Job *job) {
+  if (job->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1) _push(job);
+}
+
+void JobSystem::_push(Job *job) {
+  auto &worker{_local()};
+  // a full deque leaves no choice but to run the job right away
+  if (!worker.deque.push(job)) return _execute(worker, job);
+
+  // pairs with the sleeper announcing itself before looking for work once
+  // more, so that either it finds this job or it is seen here
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (_sleeping.load(std::memory_order_relaxed)) {
+    _epoch.fetch_add(1, std::memory_order_relaxed);
+    _epoch.notify_one();
+  }
+}
+
+JobSystem::Job *JobSystem::_find(Worker &worker) {
+  if (auto job{worker.deque.pop()}) return job;
+
+  auto count{unsigned(_workers.size())};
+  worker.random ^= worker.random << 13;
+  worker.random ^= worker.random >> 17;
+  worker.random ^= worker.random << 5;
+  for (unsigned i = 0, first = worker.random % count; i < count; ++i) {
+    auto &victim{*_workers[(first + i) % count]};
+    if (&victim == &worker) continue;
+    if (auto job{victim.deque.steal()}) {
+      worker.stolen.fetch_add(1, std::memory_order_relaxed);
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+void JobSystem::_execute(Worker &worker, Job *job) {
+  job->function(*job);
+  worker.executed.fetch_add(1, std::memory_order_relaxed);
+  _finish(job);
+}
+
+void JobSystem::_finish(Job *job) {
+  // read before finishing, as the slot may be reused right after
+  auto parent{job->parent};
+  Job *dependents[maxDependents];
+  auto dependentCount{job->dependentCount};
+  std::copy_n(job->dependents, dependentCount, dependents);
+
+  if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+  for (uint32_t i = 0; i < dependentCount; ++i) run(dependents[i]);
+  if (parent) _finish(parent);
+}
+
+void JobSystem::wait(const Job *job) {
+  auto &worker{_local()};
+  while (job->unfinished.load(std::memory_order_acquire)) {
+    if (auto other{_find(worker)})
+      _execute(worker, other);
+    else
+      std::this_thread::yield();
+  }
+}
+
+void JobSystem::_work(unsigned index) {
+  auto &worker{*_workers[index]};
+  _current = &worker;
+
+  static constexpr int spinCount{64};
+  int idle{};
+  while (!_stop.load(std::memory_order_relaxed)) {
+    if (auto job{_find(worker)}) {
+      _execute(worker, job);
+      idle = 0;
+      continue;
+    }
+    if (++idle < spinCount) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    // nothing to do for a while: sleep until jobs are queued
+    auto epoch{_epoch.load(std::memory_order_relaxed)};
+    _sleeping.fetch_add(1, std::memory_order_seq_cst);
+    if (auto job{_find(worker)}) {
+      _sleeping.fetch_sub(1, std::memory_order_relaxed);
+      _execute(worker, job);
+      idle = 0;
+      continue;
+    }
+    if (!_stop.load()) _epoch.wait(epoch, std::memory_order_relaxed);
+    _sleeping.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
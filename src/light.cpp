@@ -1,5 +1,8 @@
 #include "light.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 Light::Light(std::string name)
     : TransformableObject{std::move(name)}, color{1}, intensity{1} {}
 
@@ -19,13 +22,15 @@ Light::Light(Light &&other) noexcept
     : TransformableObject{std::move(other)}, color{std::move(other.color)},
       intensity{other.intensity} {}
 
+float Light::range() const {
+  auto brightest{std::max({color.r, color.g, color.b})};
+  return std::sqrt(std::max(intensity * brightest, 0.0f) / cutoff);
+}
+
 Light &Light::operator=(const Light &other) {
   if (&other == this)
     goto skip;
   this->TransformableObject::operator=(other);
-  _name = other._name;
-  //_children = other._children;
-  _transform = other._transform;
   color = other.color;
   intensity = other.intensity;
 skip:
@@ -35,9 +40,7 @@ skip:
 Light &Light::operator=(Light &&other) noexcept {
   if (&other == this)
     goto skip;
-  _name = std::move(other._name);
-  //_children = std::move(other._children);
-  _transform = std::move(other._transform);
+  this->TransformableObject::operator=(std::move(other));
   color = std::move(other.color);
   intensity = other.intensity;
 skip:
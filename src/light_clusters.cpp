@@ -0,0 +1,156 @@
+#include "light_clusters.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "cpu_profiler.hpp"
+#include "gl_util.hpp"
+#include "job_system.hpp"
+
+// columns (or rows) of froxels a sphere may overlap between two depths, found
+// from the slopes of its sides; first > second when there are none
+static std::pair<int, int> span(float center, float radius, float near,
+                                float far, float tan, unsigned count) {
+  auto lo{std::min((center - radius) / near, (center - radius) / far)};
+  auto hi{std::max((center + radius) / near, (center + radius) / far)};
+  if (hi < -tan || lo > tan) return {1, 0};
+  auto toIndex{[&](float slope) {
+    // the shaders find the froxel of a fragment the same way
+    auto i{int(std::floor((0.5f * slope / tan + 0.5f) * count))};
+    return std::clamp(i, 0, int(count) - 1);
+  }};
+  return {toIndex(lo), toIndex(hi)};
+}
+
+static bool overlaps(const Aabb &box, vec3 center, float radius) {
+  auto d{center - clamp(center, box.a, box.b)};
+  return dot(d, d) <= radius * radius;
+}
+
+LightClusters::LightClusters()
+    : _lists(countX * countY * countZ), _clusters(countX * countY * countZ) {
+  glCheck(glGenBuffers(1, &_lightBuffer));
+  glCheck(glGenBuffers(1, &_clusterBuffer));
+  glCheck(glGenBuffers(1, &_indexBuffer));
+}
+
+LightClusters::~LightClusters() {
+  glCheck(glDeleteBuffers(1, &_lightBuffer));
+  glCheck(glDeleteBuffers(1, &_clusterBuffer));
+  glCheck(glDeleteBuffers(1, &_indexBuffer));
+}
+
+float LightClusters::_sliceDepth(unsigned slice) const {
+  return _near * std::pow(_far / _near, float(slice) / countZ);
+}
+
+void LightClusters::_updateBounds() {
+  _bounds.resize(countX * countY * countZ);
+  for (unsigned z = 0; z < countZ; ++z) {
+    auto near{_sliceDepth(z)}, far{_sliceDepth(z + 1)};
+    for (unsigned y = 0; y < countY; ++y) {
+      auto y0{(2.0f * y / countY - 1) * _tanY};
+      auto y1{(2.0f * (y + 1) / countY - 1) * _tanY};
+      for (unsigned x = 0; x < countX; ++x) {
+        auto x0{(2.0f * x / countX - 1) * _tanX};
+        auto x1{(2.0f * (x + 1) / countX - 1) * _tanX};
+        auto &box{_bounds[(z * countY + y) * countX + x]};
+        // the camera looks down -z, sides widening with depth
+        box.a = {std::min(x0 * near, x0 * far), std::min(y0 * near, y0 * far),
+                 -far};
+        box.b = {std::max(x1 * near, x1 * far), std::max(y1 * near, y1 * far),
+                 -near};
+      }
+    }
+  }
+}
+
+void LightClusters::build(const std::vector<Light *> &lights,
+                          const Camera &camera) {
+  PROFILE_ZONE("LightClusters::build");
+  auto tanY{std::tan(glm::radians(camera.fov()) / 2)};
+  auto tanX{tanY * camera.aspect()};
+  if (tanX != _tanX || tanY != _tanY || camera.near() != _near ||
+      camera.far() != _far) {
+    _tanX = tanX;
+    _tanY = tanY;
+    _near = camera.near();
+    _far = camera.far();
+    _updateBounds();
+  }
+
+  auto view{camera.worldToCamera()};
+  _lights.resize(lights.size());
+  for (size_t i = 0; i < lights.size(); ++i) {
+    auto light{lights[i]};
+    _lights[i] = {vec4{vec3{view * light->worldTransform()[3]}, light->range()},
+                  vec4{light->intensity * light->color, 1}};
+  }
+
+  // slices don't share froxels, so they are filled independently
+  auto fillSlice{[this](unsigned z) {
+    auto near{_sliceDepth(z)}, far{_sliceDepth(z + 1)};
+    auto first{z * countX * countY};
+    for (auto i{first}; i < first + countX * countY; ++i)
+      _lists[i].clear();
+
+    for (GLuint l = 0; l < _lights.size(); ++l) {
+      vec3 p{_lights[l].positionRange};
+      auto r{_lights[l].positionRange.w};
+      // depths the sphere covers within the slice
+      auto lo{std::max(-p.z - r, near)}, hi{std::min(-p.z + r, far)};
+      if (lo > hi) continue;
+      auto [x0, x1]{span(p.x, r, lo, hi, _tanX, countX)};
+      auto [y0, y1]{span(p.y, r, lo, hi, _tanY, countY)};
+      for (auto y{y0}; y <= y1; ++y)
+        for (auto x{x0}; x <= x1; ++x)
+          if (auto i{first + y * countX + x}; overlaps(_bounds[i], p, r))
+            _lists[i].push_back(l);
+    }
+  }};
+  JobSystem::instance().parallelFor(0, countZ, 1,
+                                    [&](size_t first, size_t last) {
+                                      for (auto z{first}; z < last; ++z)
+                                        fillSlice(unsigned(z));
+                                    });
+
+  _indices.clear();
+  _maxLightsPerCluster = 0;
+  for (size_t i = 0; i < _lists.size(); ++i) {
+    _clusters[i] = {GLuint(_indices.size()), GLuint(_lists[i].size())};
+    _indices.insert(_indices.end(), _lists[i].begin(), _lists[i].end());
+    _maxLightsPerCluster =
+        std::max(_maxLightsPerCluster, unsigned(_lists[i].size()));
+  }
+
+  glCheck(glBindBuffer(GL_SHADER_STORAGE_BUFFER, _lightBuffer));
+  glCheck(glBufferData(GL_SHADER_STORAGE_BUFFER,
+                       _lights.size() * sizeof(ClusterLight), _lights.data(),
+                       GL_STREAM_DRAW));
+  glCheck(glBindBuffer(GL_SHADER_STORAGE_BUFFER, _clusterBuffer));
+  glCheck(glBufferData(GL_SHADER_STORAGE_BUFFER,
+                       _clusters.size() * sizeof(uvec2), _clusters.data(),
+                       GL_STREAM_DRAW));
+  glCheck(glBindBuffer(GL_SHADER_STORAGE_BUFFER, _indexBuffer));
+  glCheck(glBufferData(GL_SHADER_STORAGE_BUFFER,
+                       _indices.size() * sizeof(GLuint), _indices.data(),
+                       GL_STREAM_DRAW));
+}
+
+void LightClusters::bind() const {
+  glCheck(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _lightBuffer));
+  glCheck(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _clusterBuffer));
+  glCheck(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _indexBuffer));
+}
+
+void LightClusters::setUniforms(FrameUniforms &uniforms) const {
+  // slice = log(depth) * scale + bias inverts _sliceDepth
+  auto scale{countZ / std::log(_far / _near)};
+  uniforms.clusterCount = {countX, countY, countZ};
+  uniforms.clusterTan = {_tanX, _tanY};
+  uniforms.clusterDepth = {scale, -std::log(_near) * scale};
+}
+
+unsigned LightClusters::maxLightsPerCluster() const {
+  return _maxLightsPerCluster;
+}
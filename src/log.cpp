@@ -0,0 +1,114 @@
+#include "log.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+Log &Log::instance() {
+  static Log log;
+  return log;
+}
+
+Log::Log() {
+  for (size_t i = 0; i < ringSize; ++i)
+    _slots[i].sequence.store(i, std::memory_order_relaxed);
+  _writer = std::thread{&Log::_write, this};
+}
+
+Log::~Log() {
+  _stop = true;
+  _pushed.fetch_add(1, std::memory_order_release);
+  _pushed.notify_one();
+  _writer.join();
+}
+
+bool Log::push(const Record &record) {
+  auto position{_tail.load(std::memory_order_relaxed)};
+  Slot *slot;
+  for (;;) {
+    slot = &_slots[position % ringSize];
+    auto sequence{slot->sequence.load(std::memory_order_acquire)};
+    auto difference{int64_t(sequence - position)};
+    if (difference == 0) {
+      // the slot is free, unless another producer claims it first
+      if (_tail.compare_exchange_weak(position, position + 1,
+                                      std::memory_order_relaxed))
+        break;
+    } else if (difference < 0) {
+      // the writer hasn't freed the slot a lap ago yet
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      position = _tail.load(std::memory_order_relaxed);
+    }
+  }
+  slot->record = record;
+  slot->sequence.store(position + 1, std::memory_order_release);
+
+  _pushed.fetch_add(1, std::memory_order_release);
+  _pushed.notify_one();
+  return true;
+}
+
+bool Log::_pop(Record &record) {
+  auto &slot{_slots[_head % ringSize]};
+  if (slot.sequence.load(std::memory_order_acquire) != _head + 1)
+    return false;
+  record = slot.record;
+  // frees the slot for the producer a lap ahead
+  slot.sequence.store(_head + ringSize, std::memory_order_release);
+  ++_head;
+  return true;
+}
+
+uint64_t Log::dropped() const {
+  return _dropped.load(std::memory_order_relaxed);
+}
+
+void Log::_write() {
+  std::vector<Record> batch;
+  for (;;) {
+    // read before draining, so that a push landing after the drain wakes us
+    auto pushed{_pushed.load(std::memory_order_acquire)};
+    auto stop{_stop.load()};
+
+    Record record;
+    while (_pop(record)) batch.push_back(record);
+    if (!batch.empty()) {
+      for (auto &r : batch)
+        if (!r.printed) fputs(r.text, stdout);
+      fflush(stdout);
+
+      std::lock_guard lock{_historyMutex};
+      for (auto &r : batch) {
+        if (_history.size() == historySize) _history.pop_front();
+        _history.push_back(r);
+      }
+      batch.clear();
+    }
+
+    if (stop) break;
+    _pushed.wait(pushed, std::memory_order_acquire);
+  }
+}
+
+static Log::Severity severityOf(const char *message) {
+  if (!std::strncmp(message, "[ERROR]", 7)) return Log::Severity::error;
+  if (!std::strncmp(message, "[WARNING]", 9)) return Log::Severity::warning;
+  return Log::Severity::info;
+}
+
+void logMsg(const char *fmt, ...) {
+  Log::Record record;
+  va_list argList;
+  va_start(argList, fmt);
+  // longer messages are cut short rather than overflow
+  vsnprintf(record.text, sizeof record.text, fmt, argList);
+  va_end(argList);
+
+  record.severity = severityOf(record.text);
+  record.printed = record.severity == Log::Severity::error;
+  if (record.printed) fputs(record.text, stderr);
+  Log::instance().push(record);
+}
@@ -1,11 +1,26 @@
-#include "dbvt_broadphase.hpp"
+#include <filesystem>
+#include <string>
+
+#include "cpu_profiler.hpp"
+#include "job_system.hpp"
+#include "object_pool.hpp"
 #include "physics/graphical_particle.hpp"
 #include "physics/particle_force_registry.hpp"
+#include "scene.hpp"
+
+int main(int argc, char** argv) {
+  // --headless <frames> renders that many frames offscreen, orbiting the
+  // origin, and saves them along with their timings under headless/
+  unsigned headlessFrames{};
+  if (argc > 2 && std::string{argv[1]} == "--headless")
+    headlessFrames = unsigned(std::stoul(argv[2]));
 
-int main() {
   constexpr size_t w{1600}, h{900};
-  Window window{w, h, "VBAG 2"};
+  Window window{w, h, "VBAG 2", headlessFrames > 0};
 
+  // outliving the scene, which points to what they hold
+  ObjectPool<GraphicalParticle> graphicalParticlePool;
+  ObjectPool<phys::ParticleSpring> springPool;
   Scene scene;
 
   constexpr int particle_count = 3;
@@ -18,7 +33,7 @@ int main() {
       particle.SetPosition(
           {0.5 * (i - particle_count / 2), 0, 0.5 * (j - particle_count / 2)});
       // particle.SetVelocity({0, 10, 0});
-      graphical_particles[index] = new GraphicalParticle{particle};
+      graphical_particles[index] = graphicalParticlePool.create(particle);
     }
   }
 
@@ -40,36 +55,55 @@ int main() {
     if (&particle != particles + 1) {
       registry.Register(&particle, &spring_1);
       registry.Register(&particles[1],
-                        new phys::ParticleSpring(&particle, 0.5, 10));
+                        springPool.create(&particle, 0.5, 10));
     }
   }
 
-  auto cam = new Camera{"cam", glm::radians(74.0f), 16 / 9.0f, 0.01f, 1000.0f};
+  auto cam = scene.createCamera(
+      {"cam", glm::radians(74.0f), 16 / 9.0f, 0.01f, 1000.0f});
   cam->translate({0, 0, 5});
 
-  auto light = new Light{"light_1", glm::vec3{1}, 100 * 100};
+  auto light = scene.createLight({"light_1", glm::vec3{1}, 100 * 100});
   light->translate({0, 100, 0});
-  scene.addLight(light);
-  light = new Light{"light_2", glm::vec3{1}, 100 * 100};
+  light = scene.createLight({"light_2", glm::vec3{1}, 100 * 100});
   light->translate({0, -100, 0});
-  scene.addLight(light);
-
-  scene.addCamera(cam);
   for (auto& graphical_particle : graphical_particles)
     scene.addActor(graphical_particle);
 
-  scene.render(window, [&] {
+  auto step = [&] {
+    PROFILE_ZONE("particle step");
     float time_step = scene.timeStep();
     registry.ApplyForces(time_step);
-    for (auto& particle : particles) {
-      particle.Integrate(time_step);
-      particle.ClearForceAccumulator();
-    }
+    // particles integrate independently of one another
+    JobSystem::instance().parallelFor(
+        0, std::size(particles), 256, [&](size_t first, size_t last) {
+          for (auto i = first; i < last; ++i) {
+            particles[i].Integrate(time_step);
+            particles[i].ClearForceAccumulator();
+          }
+        });
 
     for (auto& graphical_particle : graphical_particles) {
       graphical_particle->Update();
     }
-  });
+  };
+
+  if (headlessFrames) {
+    std::filesystem::create_directories("headless");
+    Scene::Script script{headlessFrames};
+    script.cameraPath = [](Camera& camera, float t) {
+      auto angle{0.5f * t};
+      camera.setPosition({5 * std::sin(angle), 1, 5 * std::cos(angle)});
+      camera.setRotation({0, angle, 0});
+      camera.updateWorldToCamera();
+    };
+    script.framePrefix = "headless/frame_";
+    script.timingsFile = "headless/timings.json";
+    script.passTimingsFile = "headless/passes.csv";
+    scene.renderHeadless(window, script, step);
+  } else {
+    scene.render(window, step);
+  }
 
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "mesh_arena.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "custom_assert.hpp"
+#include "gl_util.hpp"
+
+RangeAllocator::RangeAllocator(size_t capacity) : _capacity{capacity} {
+  if (capacity) _free.emplace(0, capacity);
+}
+
+size_t RangeAllocator::allocate(size_t size) {
+  if (size == 0) return 0;
+  auto it{std::find_if(_free.begin(), _free.end(),
+                       [size](auto &range) { return range.second >= size; })};
+  if (it == _free.end()) return invalid;
+
+  auto [offset, available]{*it};
+  _free.erase(it);
+  if (available > size) _free.emplace(offset + size, available - size);
+  _used += size;
+  return offset;
+}
+
+void RangeAllocator::free(size_t offset, size_t size) {
+  ASSERT(offset + size <= _capacity, "range [%zu, %zu) is out of bounds\n",
+         offset, offset + size);
+  if (size == 0) return;
+  _used -= size;
+
+  auto next{_free.lower_bound(offset)};
+  // merging with the following free range
+  if (next != _free.end() && next->first == offset + size) {
+    size += next->second;
+    next = _free.erase(next);
+  }
+  // merging with the preceding free range
+  if (next != _free.begin()) {
+    auto prev{std::prev(next)};
+    if (prev->first + prev->second == offset) {
+      prev->second += size;
+      return;
+    }
+  }
+  _free.emplace(offset, size);
+}
+
+void RangeAllocator::grow(size_t capacity) {
+  ASSERT(capacity >= _capacity, "can't shrink from %zu to %zu\n", _capacity,
+         capacity);
+  if (capacity == _capacity) return;
+  auto oldCapacity{_capacity};
+  _capacity = capacity;
+  _used += capacity - oldCapacity;  // undone by free
+  free(oldCapacity, capacity - oldCapacity);
+}
+
+size_t RangeAllocator::capacity() const { return _capacity; }
+
+size_t RangeAllocator::used() const { return _used; }
+
+MeshArena::MeshArena() {
+  glCheck(glGenBuffers(1, &_vertices));
+  glCheck(glGenBuffers(1, &_indices));
+}
+
+MeshArena::~MeshArena() {
+  glCheck(glDeleteBuffers(1, &_vertices));
+  glCheck(glDeleteBuffers(1, &_indices));
+}
+
+MeshArena::Allocation MeshArena::allocate(const TriangleMesh *mesh) {
+  auto &v{mesh->vertices()}, &n{mesh->normals()};
+  auto &uv{mesh->uv()};
+  auto &t{mesh->triangles()};
+  auto vertexCount{v.size()}, indexCount{3 * t.size()};
+
+  // doubling until both ranges fit
+  auto reserve{[](RangeAllocator &ranges, GLuint &buffer, size_t count,
+                  size_t elementSize) {
+    auto offset{ranges.allocate(count)};
+    while (offset == RangeAllocator::invalid) {
+      auto oldCapacity{ranges.capacity()};
+      auto newCapacity{std::max(2 * oldCapacity, oldCapacity + count)};
+      _grow(buffer, oldCapacity * elementSize, newCapacity * elementSize);
+      ranges.grow(newCapacity);
+      offset = ranges.allocate(count);
+    }
+    return offset;
+  }};
+  auto baseVertex{
+      reserve(_vertexRanges, _vertices, vertexCount, sizeof(ArenaVertex))};
+  auto firstIndex{
+      reserve(_indexRanges, _indices, indexCount, sizeof(GLuint))};
+
+  // interleaving positions, normals, and uv, which may be missing
+  std::vector<ArenaVertex> vertices(vertexCount);
+  for (size_t i = 0; i < vertexCount; ++i)
+    vertices[i] = {v[i], i < n.size() ? n[i] : vec3{},
+                   i < uv.size() ? uv[i] : vec2{}};
+
+  glCheck(glBindBuffer(GL_ARRAY_BUFFER, _vertices));
+  glCheck(glBufferSubData(GL_ARRAY_BUFFER, baseVertex * sizeof(ArenaVertex),
+                          vertexCount * sizeof(ArenaVertex), vertices.data()));
+  // indices stay relative to the mesh, the draw's base vertex offsets them
+  glCheck(glBindBuffer(GL_COPY_WRITE_BUFFER, _indices));
+  glCheck(glBufferSubData(GL_COPY_WRITE_BUFFER, firstIndex * sizeof(GLuint),
+                          indexCount * sizeof(GLuint), t.data()));
+
+  return {GLint(baseVertex), GLuint(firstIndex), GLuint(indexCount),
+          GLuint(vertexCount)};
+}
+
+void MeshArena::free(const Allocation &allocation) {
+  _vertexRanges.free(allocation.baseVertex, allocation.vertexCount);
+  _indexRanges.free(allocation.firstIndex, allocation.indexCount);
+}
+
+void MeshArena::bind() const {
+  constexpr auto stride{GLsizei(sizeof(ArenaVertex))};
+
+  glCheck(glBindBuffer(GL_ARRAY_BUFFER, _vertices));
+  glCheck(glEnableVertexAttribArray(0));
+  glCheck(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride,
+                                (const void *)offsetof(ArenaVertex, p)));
+  glCheck(glEnableVertexAttribArray(1));
+  glCheck(glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride,
+                                (const void *)offsetof(ArenaVertex, n)));
+  glCheck(glEnableVertexAttribArray(2));
+  glCheck(glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride,
+                                (const void *)offsetof(ArenaVertex, uv)));
+  glCheck(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indices));
+}
+
+size_t MeshArena::vertexCount() const { return _vertexRanges.used(); }
+
+size_t MeshArena::indexCount() const { return _indexRanges.used(); }
+
+void MeshArena::_grow(GLuint &buffer, size_t oldBytes, size_t newBytes) {
+  GLuint grown;
+  glCheck(glGenBuffers(1, &grown));
+  glCheck(glBindBuffer(GL_COPY_WRITE_BUFFER, grown));
+  glCheck(glBufferData(GL_COPY_WRITE_BUFFER, newBytes, nullptr,
+                       GL_STATIC_DRAW));
+  if (oldBytes) {
+    glCheck(glBindBuffer(GL_COPY_READ_BUFFER, buffer));
+    glCheck(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0,
+                                0, oldBytes));
+  }
+  glCheck(glDeleteBuffers(1, &buffer));
+  buffer = grown;
+}
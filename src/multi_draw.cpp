@@ -0,0 +1,53 @@
+#include "multi_draw.hpp"
+
+#include "cpu_profiler.hpp"
+#include "gl_util.hpp"
+
+MultiDraw::MultiDraw() { glCheck(glGenBuffers(1, &_commandBuffer)); }
+
+MultiDraw::~MultiDraw() { glCheck(glDeleteBuffers(1, &_commandBuffer)); }
+
+void MultiDraw::build(const std::vector<InstanceBatcher::Batch> &batches,
+                      const GpuResources &resources) {
+  PROFILE_ZONE("MultiDraw::build");
+  _commands.clear();
+  _ranges.clear();
+
+  for (auto &batch : batches) {
+    if (batch.instanceCount == 0) continue;
+    auto &mesh{resources.mesh(batch.mesh)};
+    _commands.push_back({mesh.indexCount, batch.instanceCount,
+                         mesh.firstIndex, mesh.baseVertex,
+                         batch.firstInstance});
+
+    if (_ranges.empty() || _ranges.back().pass != batch.pass ||
+        *_ranges.back().texture != *batch.texture)
+      _ranges.push_back(
+          {batch.pass, batch.texture, GLuint(_commands.size() - 1), 0});
+    ++_ranges.back().drawCount;
+  }
+
+  glCheck(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commandBuffer));
+  glCheck(glBufferData(GL_DRAW_INDIRECT_BUFFER,
+                       _commands.size() * sizeof(DrawElementsIndirectCommand),
+                       _commands.data(), GL_STREAM_DRAW));
+}
+
+void MultiDraw::bind() const {
+  glCheck(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commandBuffer));
+}
+
+void MultiDraw::draw(const Range &range) const {
+  auto offset{range.firstDraw * sizeof(DrawElementsIndirectCommand)};
+  glCheck(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                      (const void *)offset, range.drawCount,
+                                      0));
+}
+
+const std::vector<MultiDraw::Range> &MultiDraw::ranges() const {
+  return _ranges;
+}
+
+const std::vector<DrawElementsIndirectCommand> &MultiDraw::commands() const {
+  return _commands;
+}
@@ -0,0 +1,262 @@
+#include "occlusion.hpp"
+
+#include <algorithm>
+
+#include "cpu_profiler.hpp"
+#include "job_system.hpp"
+
+// SSE2 is part of x86-64, so no runtime dispatch is needed
+#include <emmintrin.h>
+
+OcclusionCuller::OcclusionCuller() : _bins(tilesX * tilesY) {
+  for (int w = width, h = height;; w = std::max(w / 2, 1),
+           h = std::max(h / 2, 1)) {
+    _levels.push_back({w, h, std::vector<float>(_levels.empty() ? 0 : w * h),
+                       std::vector<float>(w * h, 1.0f)});
+    if (w == 1 && h == 1) break;
+  }
+}
+
+bool OcclusionCuller::setUp(vec3 v0, vec3 v1, vec3 v2, Triangle &t) {
+  auto area{(v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y)};
+  if (area == 0) return false;
+  // counterclockwise, so that edge functions are positive inside; occluders
+  // hide what is behind them whichever side faces the camera
+  if (area < 0) {
+    std::swap(v1, v2);
+    area = -area;
+  }
+
+  // pixels whose centers may be covered, clamped while still floats since
+  // vertices near the camera plane can land arbitrarily far away
+  auto lo{floor(min(min(vec2{v0}, vec2{v1}), vec2{v2}))};
+  auto hi{ceil(max(max(vec2{v0}, vec2{v1}), vec2{v2}))};
+  if (lo.x > width - 1 || lo.y > height - 1 || hi.x < 0 || hi.y < 0)
+    return false;
+  t.minX = int(std::max(lo.x, 0.0f));
+  t.minY = int(std::max(lo.y, 0.0f));
+  t.maxX = int(std::min(hi.x, float(width - 1)));
+  t.maxY = int(std::min(hi.y, float(height - 1)));
+
+  const vec3 v[]{v0, v1, v2};
+  for (int i = 0; i < 3; ++i) {
+    auto a{v[i]}, b{v[(i + 1) % 3]};
+    t.edgeA[i] = a.y - b.y;
+    t.edgeB[i] = b.x - a.x;
+    t.edgeC[i] = -(t.edgeA[i] * a.x + t.edgeB[i] * a.y);
+  }
+
+  t.depthA = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) /
+             area;
+  t.depthB = ((v1.x - v0.x) * (v2.z - v0.z) - (v2.x - v0.x) * (v1.z - v0.z)) /
+             area;
+  t.depthC = v0.z - t.depthA * v0.x - t.depthB * v0.y;
+  return true;
+}
+
+void OcclusionCuller::render(const std::vector<const Actor *> &occluders,
+                             const mat4 &viewProjection) {
+  PROFILE_ZONE("OcclusionCuller::render");
+  _viewProjection = viewProjection;
+  _arena.reset();
+
+  // transforming occluder triangles to window space
+  _triangles.clear();
+  FrameVector<vec4> clip{_arena};
+  for (auto occluder : occluders) {
+    auto m{viewProjection * occluder->worldTransform()};
+    auto &vertices{occluder->mesh()->vertices()};
+    clip.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+      clip[i] = m * vec4{vertices[i], 1};
+
+    for (auto &[i0, i1, i2] : occluder->mesh()->triangles()) {
+      auto c0{clip[i0]}, c1{clip[i1]}, c2{clip[i2]};
+      // anything reaching past the near plane is left out
+      if (c0.z < -c0.w || c1.z < -c1.w || c2.z < -c2.w) continue;
+      auto toWindow{[](vec4 c) {
+        vec3 ndc{vec3{c} / c.w};
+        return vec3{(0.5f * ndc.x + 0.5f) * width,
+                    (0.5f * ndc.y + 0.5f) * height, 0.5f * ndc.z + 0.5f};
+      }};
+      Triangle t;
+      if (setUp(toWindow(c0), toWindow(c1), toWindow(c2), t))
+        _triangles.push_back(t);
+    }
+  }
+
+  // binning triangles into the tiles their bounds touch
+  for (auto &bin : _bins) bin.clear();
+  for (unsigned i = 0; i < _triangles.size(); ++i) {
+    auto &t{_triangles[i]};
+    for (int ty = t.minY / tileHeight; ty <= t.maxY / tileHeight; ++ty)
+      for (int tx = t.minX / tileWidth; tx <= t.maxX / tileWidth; ++tx)
+        _bins[ty * tilesX + tx].push_back(i);
+  }
+
+  // tiles don't share pixels, so they are rasterized independently
+  JobSystem::instance().parallelFor(
+      0, tilesX * tilesY, 1, [this](size_t first, size_t last) {
+        for (auto tile = first; tile < last; ++tile) _rasterizeTile(int(tile));
+      });
+
+  _buildPyramid();
+}
+
+void OcclusionCuller::_rasterizeTile(int tile) {
+  auto tileX{tile % tilesX * tileWidth}, tileY{tile / tilesX * tileHeight};
+  auto depth{_levels[0].max.data()};
+
+  for (int y = tileY; y < tileY + tileHeight; ++y)
+    std::fill_n(depth + y * width + tileX, tileWidth, 1.0f);
+
+  const auto laneOffsets{_mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f)};
+  const auto zero{_mm_setzero_ps()};
+
+  for (auto i : _bins[tile]) {
+    auto &t{_triangles[i]};
+    // clipping the bounds to the tile, starting on a group of four pixels
+    auto minX{std::max(t.minX, tileX) & ~3};
+    auto maxX{std::min(t.maxX, tileX + tileWidth - 1)};
+    auto minY{std::max(t.minY, tileY)};
+    auto maxY{std::min(t.maxY, tileY + tileHeight - 1)};
+
+    __m128 a[3], b[3], c[3];
+    for (int e = 0; e < 3; ++e) {
+      a[e] = _mm_set1_ps(t.edgeA[e]);
+      b[e] = _mm_set1_ps(t.edgeB[e]);
+      c[e] = _mm_set1_ps(t.edgeC[e]);
+    }
+    auto za{_mm_set1_ps(t.depthA)}, zb{_mm_set1_ps(t.depthB)},
+        zc{_mm_set1_ps(t.depthC)};
+
+    for (int y = minY; y <= maxY; ++y) {
+      auto py{_mm_set1_ps(y + 0.5f)};
+      // the row-constant part of every plane
+      __m128 rowEdge[3];
+      for (int e = 0; e < 3; ++e)
+        rowEdge[e] = _mm_add_ps(_mm_mul_ps(b[e], py), c[e]);
+      auto rowDepth{_mm_add_ps(_mm_mul_ps(zb, py), zc)};
+
+      auto row{depth + y * width};
+      for (int x = minX; x <= maxX; x += 4) {
+        auto px{_mm_add_ps(_mm_set1_ps(float(x)), laneOffsets)};
+        auto inside{_mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(a[0], px), rowEdge[0]),
+                                 zero)};
+        for (int e = 1; e < 3; ++e)
+          inside = _mm_and_ps(
+              inside,
+              _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(a[e], px), rowEdge[e]),
+                           zero));
+        if (!_mm_movemask_ps(inside)) continue;
+
+        auto z{_mm_add_ps(_mm_mul_ps(za, px), rowDepth)};
+        auto old{_mm_loadu_ps(row + x)};
+        auto nearer{_mm_min_ps(old, z)};
+        _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer),
+                                         _mm_andnot_ps(inside, old)));
+      }
+    }
+  }
+}
+
+void OcclusionCuller::_buildPyramid() {
+  for (size_t l = 1; l < _levels.size(); ++l) {
+    auto &fine{_levels[l - 1]};
+    auto &coarse{_levels[l]};
+    auto &fineMin{l == 1 ? fine.max : fine.min};
+    for (int y = 0; y < coarse.height; ++y) {
+      for (int x = 0; x < coarse.width; ++x) {
+        auto x0{2 * x}, y0{2 * y};
+        auto x1{std::min(x0 + 1, fine.width - 1)};
+        auto y1{std::min(y0 + 1, fine.height - 1)};
+        auto i00{y0 * fine.width + x0}, i01{y0 * fine.width + x1},
+            i10{y1 * fine.width + x0}, i11{y1 * fine.width + x1};
+        coarse.min[y * coarse.width + x] = std::min(
+            {fineMin[i00], fineMin[i01], fineMin[i10], fineMin[i11]});
+        coarse.max[y * coarse.width + x] = std::max(
+            {fine.max[i00], fine.max[i01], fine.max[i10], fine.max[i11]});
+      }
+    }
+  }
+}
+
+bool OcclusionCuller::isVisible(const Aabb &bounds) const {
+  vec2 lo{std::numeric_limits<float>::max()}, hi{-lo};
+  auto nearest{1.0f};
+  // corners are the transformed minimum corner plus transformed box edges
+  auto size{bounds.size()};
+  auto base{_viewProjection * vec4{bounds.a, 1}};
+  vec4 edges[]{_viewProjection[0] * size.x, _viewProjection[1] * size.y,
+               _viewProjection[2] * size.z};
+  for (int i = 0; i < 8; ++i) {
+    auto c{base};
+    if (i & 1) c += edges[0];
+    if (i & 2) c += edges[1];
+    if (i & 4) c += edges[2];
+    // boxes reaching past the near plane are never hidden
+    if (c.z < -c.w) return true;
+    vec3 ndc{vec3{c} / c.w};
+    vec2 window{(0.5f * ndc.x + 0.5f) * width, (0.5f * ndc.y + 0.5f) * height};
+    lo = min(lo, window);
+    hi = max(hi, window);
+    nearest = std::min(nearest, 0.5f * ndc.z + 0.5f);
+  }
+
+  if (lo.x >= width || lo.y >= height || hi.x < 0 || hi.y < 0)
+    return false;  // off screen
+  auto x0{int(std::max(lo.x, 0.0f))}, y0{int(std::max(lo.y, 0.0f))};
+  auto x1{int(std::min(hi.x, width - 1.0f))};
+  auto y1{int(std::min(hi.y, height - 1.0f))};
+
+  // starting where the rectangle spans at most 2x2 texels
+  int level{};
+  while (level + 1 < int(_levels.size()) &&
+         ((x1 >> level) - (x0 >> level) > 1 ||
+          (y1 >> level) - (y0 >> level) > 1))
+    ++level;
+  return _visibleIn(level, x0, y0, x1, y1, nearest);
+}
+
+bool OcclusionCuller::_visibleIn(int level, int x0, int y0, int x1, int y1,
+                                 float nearest) const {
+  auto &l{_levels[level]};
+  auto &lMin{level == 0 ? l.max : l.min};
+  for (int ty = y0 >> level; ty <= y1 >> level; ++ty) {
+    for (int tx = x0 >> level; tx <= x1 >> level; ++tx) {
+      // everything under this texel is nearer than the box
+      if (l.max[ty * l.width + tx] < nearest) continue;
+      // everything under this texel is at least as far as the box
+      if (lMin[ty * l.width + tx] >= nearest) return true;
+      // mixed, refining the part of the rectangle under this texel
+      auto sx0{std::max(x0, tx << level)}, sy0{std::max(y0, ty << level)};
+      auto sx1{std::min(x1, ((tx + 1) << level) - 1)};
+      auto sy1{std::min(y1, ((ty + 1) << level) - 1)};
+      if (_visibleIn(level - 1, sx0, sy0, sx1, sy1, nearest)) return true;
+    }
+  }
+  return false;
+}
+
+void OcclusionCuller::cull(std::vector<const Actor *> &actors) const {
+  PROFILE_ZONE("OcclusionCuller::cull");
+  FrameVector<char> visible(actors.size(), _arena);
+  JobSystem::instance().parallelFor(
+      0, actors.size(), 64, [&](size_t first, size_t last) {
+        for (auto i = first; i < last; ++i)
+          visible[i] = isVisible(actors[i]->bounds());
+      });
+  size_t kept{};
+  for (size_t i = 0; i < actors.size(); ++i)
+    if (visible[i]) actors[kept++] = actors[i];
+  actors.resize(kept);
+}
+
+const std::vector<OcclusionCuller::Triangle> &OcclusionCuller::triangles()
+    const {
+  return _triangles;
+}
+
+const std::vector<float> &OcclusionCuller::depthBuffer() const {
+  return _levels[0].max;
+}
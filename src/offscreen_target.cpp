@@ -0,0 +1,75 @@
+#include "offscreen_target.hpp"
+
+#include <cstring>
+#include <vector>
+
+#include "custom_assert.hpp"
+#include "gl_util.hpp"
+
+OffscreenTarget::OffscreenTarget() {
+  glCheck(glGenFramebuffers(1, &_framebuffer));
+  glCheck(glGenRenderbuffers(1, &_color));
+  glCheck(glGenRenderbuffers(1, &_depth));
+}
+
+OffscreenTarget::~OffscreenTarget() {
+  glCheck(glDeleteFramebuffers(1, &_framebuffer));
+  glCheck(glDeleteRenderbuffers(1, &_color));
+  glCheck(glDeleteRenderbuffers(1, &_depth));
+}
+
+void OffscreenTarget::resize(GLsizei width, GLsizei height) {
+  if (width == _width && height == _height) return;
+  _width = width;
+  _height = height;
+
+  glCheck(glBindRenderbuffer(GL_RENDERBUFFER, _color));
+  glCheck(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+  glCheck(glBindRenderbuffer(GL_RENDERBUFFER, _depth));
+  // GBuffer::blitDepth requires the G-buffer's depth format
+  glCheck(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width,
+                                height));
+  glCheck(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+
+  glCheck(glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer));
+  glCheck(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                    GL_RENDERBUFFER, _color));
+  glCheck(glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+                                    GL_DEPTH_STENCIL_ATTACHMENT,
+                                    GL_RENDERBUFFER, _depth));
+
+  GLenum status;
+  glCheck(status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+  ASSERT(status == GL_FRAMEBUFFER_COMPLETE, "offscreen target incomplete: 0x%x",
+         status);
+  glCheck(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+GLuint OffscreenTarget::framebuffer() const { return _framebuffer; }
+
+void OffscreenTarget::read(PortablePixelMap &image) const {
+  ASSERT(image.width() == size_t(_width) && image.height() == size_t(_height),
+         "image is %zux%zu, target is %dx%d", image.width(), image.height(),
+         _width, _height);
+
+  std::vector<char> rows(3 * size_t(_width) * _height);
+  glCheck(glBindFramebuffer(GL_READ_FRAMEBUFFER, _framebuffer));
+  glCheck(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+  glCheck(glReadPixels(0, 0, _width, _height, GL_RGB, GL_UNSIGNED_BYTE,
+                       rows.data()));
+  glCheck(glBindFramebuffer(GL_READ_FRAMEBUFFER, 0));
+
+  // GL's rows go bottom to top
+  auto rowSize{3 * size_t(_width)};
+  for (size_t y = 0; y < size_t(_height); ++y)
+    std::memcpy(image.pixels() + y * rowSize,
+                rows.data() + (_height - 1 - y) * rowSize, rowSize);
+}
+
+void OffscreenTarget::copyTo(GLuint framebuffer) const {
+  glCheck(glBindFramebuffer(GL_READ_FRAMEBUFFER, _framebuffer));
+  glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer));
+  glCheck(glBlitFramebuffer(0, 0, _width, _height, 0, 0, _width, _height,
+                            GL_COLOR_BUFFER_BIT, GL_NEAREST));
+  glCheck(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+}
@@ -6,7 +6,7 @@
 #include "log.hpp"
 
 PortablePixelMap::PortablePixelMap(const std::string &file) {
-  std::ifstream is{file};
+  std::ifstream is{file, std::ios::binary};
   if (!is) {
     logMsg("[ERROR] Could not open file %s, terminating", file.c_str());
     std::terminate();
@@ -24,6 +24,10 @@ PortablePixelMap::PortablePixelMap(const std::string &file) {
   is.read(_pixels, 3 * _width * _height);
 }
 
+PortablePixelMap::PortablePixelMap(size_t width, size_t height)
+    : _pixels{new char[3 * width * height]{}}, _width{width},
+      _height{height} {}
+
 PortablePixelMap::~PortablePixelMap() {
   if (_pixels)
     delete[] _pixels;
@@ -31,6 +35,15 @@ PortablePixelMap::~PortablePixelMap() {
 
 const char *PortablePixelMap::pixels() const { return _pixels; }
 
+char *PortablePixelMap::pixels() { return _pixels; }
+
 size_t PortablePixelMap::width() const { return _width; }
 
 size_t PortablePixelMap::height() const { return _height; }
+
+bool PortablePixelMap::write(const std::string &file) const {
+  std::ofstream os{file, std::ios::binary};
+  os << "P6\n" << _width << ' ' << _height << "\n255\n";
+  os.write(_pixels, 3 * _width * _height);
+  return bool(os);
+}
@@ -0,0 +1,68 @@
+#include "render_queue.hpp"
+
+#include "cpu_profiler.hpp"
+#include "custom_assert.hpp"
+#include "radix_sort.hpp"
+
+static_assert(RenderQueue::depthBits + RenderQueue::meshBits +
+                      RenderQueue::textureBits + RenderQueue::programBits +
+                      RenderQueue::passBits ==
+                  64,
+              "render queue keys must fill 64 bits");
+
+// ids are handed out anew every frame, so that meshes and textures no longer
+// drawn don't keep theirs, nor a freed mesh's address a stale one
+void RenderQueue::clear() {
+  _items.clear();
+  // gone before the arena is rewound, as some implementations allocate even
+  // for empty maps
+  _textureIds.reset();
+  _meshIds.reset();
+  _idArena.reset();
+  _textureIds.emplace(_idArena);
+  _meshIds.emplace(_idArena);
+}
+
+unsigned RenderQueue::_textureId(const std::string &texture) {
+  if (texture.empty()) return 0;
+  auto [it, isNew]{_textureIds->try_emplace(std::string_view{texture})};
+  if (isNew) it->second = unsigned(_textureIds->size());
+  ASSERT(it->second < 1u << textureBits, "more than %u textures queued",
+         (1u << textureBits) - 1);
+  return it->second;
+}
+
+unsigned RenderQueue::_meshId(const TriangleMesh *mesh) {
+  auto [it, isNew]{_meshIds->try_emplace(mesh)};
+  if (isNew) it->second = unsigned(_meshIds->size() - 1);
+  ASSERT(it->second < 1u << meshBits, "more than %u meshes queued",
+         1u << meshBits);
+  return it->second;
+}
+
+void RenderQueue::push(const Actor *actor, Pass pass, unsigned program,
+                       float depth) {
+  ASSERT(program < 1u << programBits, "program %u doesn't fit in a key",
+         program);
+  auto key{uint64_t(pass)};
+  key = key << programBits | program;
+  key = key << textureBits | _textureId(actor->material().map_Kd);
+  key = key << meshBits | _meshId(actor->mesh());
+  key = key << depthBits | sortableBits(depth) >> (32 - depthBits);
+  _items.push_back({key, actor});
+}
+
+void RenderQueue::sort() {
+  PROFILE_ZONE("RenderQueue::sort");
+  radixSort(_items, _scratch, [](const Item &item) { return item.key; });
+}
+
+const std::vector<RenderQueue::Item> &RenderQueue::items() const {
+  return _items;
+}
+
+uint64_t RenderQueue::stateOf(uint64_t key) { return key >> depthBits; }
+
+RenderQueue::Pass RenderQueue::passOf(uint64_t key) {
+  return Pass(key >> (64 - passBits));
+}
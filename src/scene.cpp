@@ -1,16 +1,31 @@
 #include "scene.hpp"
 
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <optional>
 
+#include "frustum_culler.hpp"
+#include "cpu_profiler.hpp"
+#include "frame_uniforms.hpp"
+#include "g_buffer.hpp"
 #include "glm/gtx/euler_angles.hpp"
+#include "gpu_resources.hpp"
+#include "gpu_profiler.hpp"
+#include "gpu_query.hpp"
+#include "instancing.hpp"
+#include "light_clusters.hpp"
 #include "log.hpp"
-#include "ppm.hpp"
+#include "multi_draw.hpp"
+#include "occlusion.hpp"
+#include "offscreen_target.hpp"
+#include "render_queue.hpp"
+#include "shader_permutations.hpp"
 
 // clang-format off
 #include "imgui/imgui.h"
-#include "imgui/imgui_impl_glfw.h"
 #include "imgui/imgui_impl_opengl3.h"
 // clang-format on
 
@@ -19,145 +34,72 @@ static inline float elapsedTime = 0;
 
 void Scene::addCamera(Camera *camera) {
   _cameras.push_back(camera);
-  _addChildren(camera);
+  _graph.add(camera);
 }
 
 void Scene::addLight(Light *light) {
   _lights.push_back(light);
-  _addChildren(light);
+  _graph.add(light);
+}
+
+void Scene::setParent(TransformableObject *object,
+                      TransformableObject *parent) {
+  _graph.setParent(object, parent);
 }
 
 const std::vector<Actor *> &Scene::actors() const { return _actors; }
 
 const std::vector<Light *> &Scene::lights() const { return _lights; }
 
-void Scene::addActor(Actor *actor) { _actors.push_back(actor); }
-
-void Scene::_addChildren(Object *object) {
-  // for (auto child : object->children()) {
-  //   if (auto actor{std::dynamic_pointer_cast<Actor>(child)})
-  //     addActor(actor);
-  //   else if (auto camera{std::dynamic_pointer_cast<Camera>(child)})
-  //     addCamera(camera);
-  //   else if (auto light{std::dynamic_pointer_cast<Light>(child)})
-  //     addLight(light);
-  // }
+void Scene::addActor(Actor *actor) {
+  _actors.push_back(actor);
+  _newActors.push_back(actor);
+  _graph.add(actor);
+}
+
+Actor *Scene::createActor(Actor actor) {
+  auto created{_actorPool.create(std::move(actor))};
+  _created.insert(created);
+  addActor(created);
+  return created;
+}
+
+Camera *Scene::createCamera(Camera camera) {
+  auto created{_cameraPool.create(std::move(camera))};
+  _created.insert(created);
+  addCamera(created);
+  return created;
+}
+
+Light *Scene::createLight(Light light) {
+  auto created{_lightPool.create(std::move(light))};
+  _created.insert(created);
+  addLight(created);
+  return created;
 }
 
-static void transferActors(std::shared_ptr<GLuint[]> &buffers,
-                           std::shared_ptr<GLuint[]> &textures,
-                           size_t &prevObjAmt, auto &actors) {
+const TriangleMesh *Scene::createMesh(TriangleMeshData data) {
+  return _meshPool.create(std::move(data));
+}
+
+// makes the actors added since the last call resident on the GPU, uploading
+// only the meshes and textures no other actor uses yet
+static void transferActors(GpuResources &resources,
+                           const std::vector<Actor *> &newActors) {
   using namespace std::chrono;
+  PROFILE_ZONE("transferActors");
 
   auto start{steady_clock::now()};
 
-  auto objAmt{actors.size()};
-
-  // vertex positions, normals, indices, and uv
-  constexpr size_t buffersPerObject{4};
-
-  if (buffers)
-    glCheck(
-        glDeleteBuffers(buffersPerObject * GLsizei(prevObjAmt), buffers.get()));
-
-  buffers = std::make_shared<GLuint[]>(
-      buffersPerObject * objAmt);  // new GLuint[buffersPerObject * objAmt];
-
-  if (textures) glCheck(glDeleteTextures(GLsizei(prevObjAmt), textures.get()));
-  textures = std::make_shared<GLuint[]>(objAmt);  // new GLuint[objAmt];
-
-  // generating buffers for each object
-  glCheck(glGenBuffers(buffersPerObject * GLsizei(objAmt), buffers.get()));
-
-  // generating 1 texture for each object (even if it remains unused)
-  glCheck(glGenTextures(GLsizei(objAmt), textures.get()));
-
-  size_t i{};
-  logMsg("[INFO] Transferring scene data to GPU...\n");
-  for (auto obj : actors) {
-    if (auto actor{dynamic_cast<Actor *>(obj)}) {
-      auto &v{actor->mesh->vertices()}, &n{actor->mesh->normals()};
-      auto &uv{actor->mesh->uv()};
-      auto &t{actor->mesh->triangles()};
-
-      // transferring vertex positions to VRAM
-      glCheck(glBindBuffer(GL_ARRAY_BUFFER, buffers[i]));
-      glCheck(glBufferData(GL_ARRAY_BUFFER, v.size() * sizeof(vec3), v.data(),
-                           GL_STATIC_DRAW));
-      //{
-      //  auto p = (vec3 *)glMapBuffer(GL_ARRAY_BUFFER, GL_READ_ONLY);
-      //  for (int k = 0; k < v.size(); ++k)
-      //    printf_s("v %.3f %.3f %.3f\n", p[k].x, p[k].y, p[k].z);
-      //  glUnmapBuffer(GL_ARRAY_BUFFER);
-      //}
-
-      // transferring vertex normals to VRAM
-      glCheck(glBindBuffer(GL_ARRAY_BUFFER, buffers[i + objAmt]));
-      glCheck(glBufferData(GL_ARRAY_BUFFER, n.size() * sizeof(vec3), n.data(),
-                           GL_STATIC_DRAW));
-      //{
-      //  auto p = (vec3 *)glMapBuffer(GL_ARRAY_BUFFER, GL_READ_ONLY);
-      //  for (int k = 0; k < n.size(); ++k)
-      //    printf_s("vn %.3f %.3f %.3f\n", p[k].x, p[k].y, p[k].z);
-      //  glUnmapBuffer(GL_ARRAY_BUFFER);
-      //}
-
-      // transferring vertex UV coords to VRAM
-      glCheck(glBindBuffer(GL_ARRAY_BUFFER, buffers[i + 2 * objAmt]));
-      glCheck(glBufferData(GL_ARRAY_BUFFER, uv.size() * sizeof(vec2), uv.data(),
-                           GL_STATIC_DRAW));
-
-      //{
-      //  auto p = (vec2 *)glMapBuffer(GL_ARRAY_BUFFER, GL_READ_ONLY);
-      //  for (int k = 0; k < uv.size(); ++k)
-      //    printf_s("uv %.3f %.3f\n", p[k].x, p[k].y);
-      //  glUnmapBuffer(GL_ARRAY_BUFFER);
-      //}
-
-      // transferring triangle vertex indices to VRAM
-      glCheck(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[i + 3 * objAmt]));
-      glCheck(glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                           t.size() * sizeof(IndexedTriangle), t.data(),
-                           GL_STATIC_DRAW));
-
-      if (auto textureFile{actor->material.map_Kd}; !textureFile.empty()) {
-        PPM bah{textureFile};
-        glCheck(glBindTexture(GL_TEXTURE_2D, textures[i]));
-        glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
-                                GL_MIRRORED_REPEAT));
-        glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
-                                GL_MIRRORED_REPEAT));
-        glCheck(
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
-        glCheck(
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
-        glCheck(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
-        glCheck(glTexImage2D(  //
-            GL_TEXTURE_2D,     // target
-            0,                 // level
-            GL_RGB,            // internalformat
-            bah.width(),       // width
-            bah.height(),      // height
-            0,                 // border
-            GL_RGB,            // format
-            GL_UNSIGNED_BYTE,  // type
-            bah.pixels()       // data
-            ));
-        glCheck(glGenerateMipmap(GL_TEXTURE_2D));
-      }
-    }
-    ++i;
-  }
-  prevObjAmt = actors.size();
+  logMsg("[INFO] Transferring %zu new actors to GPU...\n", newActors.size());
+  for (auto actor : newActors) resources.acquire(actor);
+
   auto end{steady_clock::now()};
   logMsg("[INFO] Data transfer complete, took %g ms\n",
          duration_cast<microseconds>(end - start).count() / 1e3f);
 }
 
-static void makeMainMenu(Scene *scene, const Window &window,
-                         std::shared_ptr<GLuint[]> &buffers,
-                         std::shared_ptr<GLuint[]> &textures,
-                         size_t &prevObjAmt) {
+static void makeMainMenu(Scene *scene, const Window &window) {
   if (drawUserInterface) {
     if (ImGui::BeginMainMenuBar()) {
       if (ImGui::BeginMenu("File")) {
@@ -169,10 +111,9 @@ static void makeMainMenu(Scene *scene, const Window &window,
               auto fileName{filePath.filename()};
               if (fileName.extension() == ".obj" &&
                   ImGui::MenuItem(fileName.string().c_str())) {
-                auto mesh{new TriangleMesh(
+                auto mesh{scene->createMesh(
                     TriangleMeshData::fromObj(filePath.string()))};
-                scene->addActor(new Actor{fileName.string(), mesh});
-                transferActors(buffers, textures, prevObjAmt, scene->actors());
+                scene->createActor({fileName.string(), mesh});
               }
             }
             ImGui::EndMenu();
@@ -185,14 +126,12 @@ static void makeMainMenu(Scene *scene, const Window &window,
         if (ImGui::BeginMenu("Scene")) {
           if (ImGui::BeginMenu("Add premade actor")) {
             if (ImGui::MenuItem("Cube")) {
-              scene->addActor(new Actor{
-                  "TEMPORARY", new TriangleMesh{TriangleMeshData::cube()}});
-              transferActors(buffers, textures, prevObjAmt, scene->actors());
+              scene->createActor(
+                  {"TEMPORARY", scene->createMesh(TriangleMeshData::cube())});
             }
             if (ImGui::MenuItem("Plane")) {
-              scene->addActor(new Actor{
-                  "TEMPORARY", new TriangleMesh{TriangleMeshData::plane()}});
-              transferActors(buffers, textures, prevObjAmt, scene->actors());
+              scene->createActor(
+                  {"TEMPORARY", scene->createMesh(TriangleMeshData::plane())});
             }
             ImGui::EndMenu();
           }
@@ -203,6 +142,15 @@ static void makeMainMenu(Scene *scene, const Window &window,
       if (ImGui::BeginMenu("View")) {
         if (ImGui::BeginMenu("Render")) {
           ImGui::MenuItem("Wireframes", "", &scene->options.wireframe);
+          ImGui::MenuItem("Deferred shading", "",
+                          &scene->options.deferredShading);
+          ImGui::MenuItem("Depth pre-pass", "", &scene->options.depthPrepass);
+          ImGui::MenuItem("Front-to-back order", "",
+                          &scene->options.frontToBack);
+          ImGui::MenuItem("Frustum culling", "",
+                          &scene->options.frustumCulling);
+          ImGui::MenuItem("Occlusion culling", "",
+                          &scene->options.occlusionCulling);
           ImGui::EndMenu();
         }
         ImGui::EndMenu();
@@ -212,65 +160,184 @@ static void makeMainMenu(Scene *scene, const Window &window,
   }
 }
 
+// the zones of every thread within the last frame, as a flame graph: one row
+// per level of nesting, threads stacked below one another
+static void makeFlameView(const Window &window,
+                          std::vector<CpuProfiler::ThreadZone> &zones) {
+  auto start{CpuProfiler::frameStart()}, end{CpuProfiler::frameEnd()};
+  if (end <= start) return;
+  CpuProfiler::collect(start, end, zones);
+
+  ImGui::SetNextWindowPos({240, 21}, ImGuiCond_FirstUseEver);
+  ImGui::SetNextWindowSize({0.5f * window.width(), 200},
+                           ImGuiCond_FirstUseEver);
+  if (ImGui::Begin("CPU profile")) {
+    ImGui::Text("%.2f ms frame", 1e-6 * double(end - start));
+    ImGui::SameLine();
+    if (ImGui::Button("Export trace") &&
+        !CpuProfiler::exportChromeTrace("cpu_trace.json"))
+      logMsg("[ERROR] Couldn't export the CPU trace\n");
+
+    auto drawList{ImGui::GetWindowDrawList()};
+    auto origin{ImGui::GetCursorScreenPos()};
+    auto width{ImGui::GetContentRegionAvail().x};
+    auto rowHeight{ImGui::GetTextLineHeightWithSpacing()};
+    auto scale{width / float(end - start)};
+
+    // zones come thread by thread
+    unsigned firstRow{}, rows{};
+    for (size_t i = 0; i < zones.size(); ++i) {
+      auto &[thread, zone]{zones[i]};
+      if (i > 0 && thread != zones[i - 1].thread) firstRow = rows;
+      rows = std::max(rows, firstRow + zone.depth + 1);
+
+      ImVec2 a{origin.x + scale * float(zone.start - start),
+               origin.y + rowHeight * float(firstRow + zone.depth)};
+      ImVec2 b{origin.x + scale * float(std::min(zone.end, end) - start),
+               a.y + rowHeight - 1};
+      // a steady color per name
+      auto hue{float(std::hash<std::string_view>{}(zone.name) % 360) / 360};
+      drawList->AddRectFilled(a, b, ImColor::HSV(hue, 0.5f, 0.7f));
+      if (b.x - a.x > ImGui::CalcTextSize(zone.name).x)
+        drawList->AddText({a.x + 2, a.y}, IM_COL32_WHITE, zone.name);
+      if (ImGui::IsMouseHoveringRect(a, b))
+        ImGui::SetTooltip("%s: %.3f ms", zone.name,
+                          1e-6 * double(zone.end - zone.start));
+    }
+    ImGui::Dummy({width, rowHeight * float(rows)});
+  }
+  ImGui::End();
+}
+
+// the records the log keeps, only those in sight being laid out, following
+// the newest as long as the view is scrolled to the bottom
+static void makeLogView(const Window &window) {
+  ImGui::SetNextWindowPos({0, 0.75f * window.height()});
+  ImGui::SetNextWindowSize({0.75f * window.width(), 0.25f * window.height()});
+  if (ImGui::Begin("log", nullptr,
+                   ImGuiWindowFlags_NoTitleBar |
+                       ImGuiWindowFlags_AlwaysVerticalScrollbar |
+                       ImGuiWindowFlags_NoResize)) {
+    auto atBottom{ImGui::GetScrollY() >= ImGui::GetScrollMaxY()};
+    Log::instance().read([](const std::deque<Log::Record> &records) {
+      static const ImVec4 colors[]{
+          {1.0f, 1.0f, 1.0f, 1.0f},  // info
+          {1.0f, 0.8f, 0.3f, 1.0f},  // warning
+          {1.0f, 0.4f, 0.4f, 1.0f},  // error
+      };
+      ImGuiListClipper clipper;
+      clipper.Begin(int(records.size()));
+      while (clipper.Step())
+        for (auto i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+          auto &record{records[size_t(i)]};
+          // one line each, for the clipper to count on
+          auto length{std::strcspn(record.text, "\n")};
+          ImGui::TextColored(colors[size_t(record.severity)], "%.*s",
+                             int(length), record.text);
+        }
+    });
+    if (auto dropped{Log::instance().dropped()})
+      ImGui::TextColored({1.0f, 0.8f, 0.3f, 1.0f}, "%llu records dropped",
+                         (unsigned long long)dropped);
+    if (atBottom) ImGui::SetScrollHereY(1.0f);
+  }
+  ImGui::End();
+}
+
 void Scene::render(const Window &window, const std::function<void()> &f) {
+  _render(window, f, nullptr);
+}
+
+void Scene::renderHeadless(const Window &window, const Script &script,
+                           const std::function<void()> &f) {
+  _render(window, f, &script);
+}
+
+// per-frame times of a scripted run: CPU ones from the start of the frame to
+// the last draw issued, GPU ones between the first and last draw executing
+struct FrameTiming {
+  double cpuMs, gpuMs;
+};
+
+static void writeTimings(const std::string &file,
+                         const std::vector<FrameTiming> &timings) {
+  std::ofstream os{file};
+  os << "{\n  \"frames\": [";
+  for (size_t i = 0; i < timings.size(); ++i)
+    os << (i ? "," : "") << "\n    {\"frame\": " << i
+       << ", \"cpu_ms\": " << timings[i].cpuMs
+       << ", \"gpu_ms\": " << timings[i].gpuMs << "}";
+  os << "\n  ]\n}\n";
+  if (!os) logMsg("[ERROR] Couldn't write timings to %s\n", file.c_str());
+}
+
+void Scene::_render(const Window &window, const std::function<void()> &f,
+                    const Script *script) {
   using namespace std::chrono;
 
   if (_cameras.empty()) return;
 
-  std::shared_ptr<GLuint[]> buffers{}, textures{};
-  auto objAmt{_actors.size()};
-  transferActors(buffers, textures, objAmt, _actors);
-
   GLuint vao;
   glCheck(glGenVertexArrays(1, &vao));
   glCheck(glBindVertexArray(vao));
 
-  bool uWasPressedInPrevFrame = false;
+  GpuResources resources;
+  InstanceBatcher batcher;
+  MultiDraw multiDraw;
+  FrustumCuller culler;
+  OcclusionCuller occlusionCuller;
+  LightClusters lightClusters;
+  GBuffer gBuffer;
+  GpuProfiler profiler;
+  GpuQuery fragmentsWithPrepass{GL_FRAGMENT_SHADER_INVOCATIONS},
+      fragmentsWithoutPrepass{GL_FRAGMENT_SHADER_INVOCATIONS};
+  RenderQueue queue;
+  std::vector<const Actor *> visible, occluders;
+  std::vector<CpuProfiler::ThreadZone> zones;
 
-  // vertex shader
-  auto vsLoc{glCreateShader(GL_VERTEX_SHADER)};
-  glCheck(glShaderSource(vsLoc, 1, &triangleMeshVertexShader, nullptr));
-  glCheck(glCompileShader(vsLoc));
-  glCheckShaderCompilation(vsLoc);
-
-  // fragment shader
-  auto fsLoc{glCreateShader(GL_FRAGMENT_SHADER)};
-  glCheck(glShaderSource(fsLoc, 1, &triangleMeshPhongFragShader, nullptr));
-  glCheck(glCompileShader(fsLoc));
-  glCheckShaderCompilation(fsLoc);
-
-  // program
-  auto program{glCreateProgram()};
-  glCheck(glAttachShader(program, vsLoc));  // sending vs to vram
-  glCheck(glAttachShader(program, fsLoc));  // sending fs to vram
-  glCheck(glLinkProgram(program));          // linking program
-  glCheckProgramLinkage(program);           // checking linkage status
-  glCheck(glUseProgram(program));           // sending program to vram
-
-  auto mLoc{glGetUniformLocation(program, "M")};
-  auto vLoc{glGetUniformLocation(program, "V")};
-  auto pLoc{glGetUniformLocation(program, "P")};
-  auto materialKaLoc{glGetUniformLocation(program, "material.Ka")};
-  auto materialKdLoc{glGetUniformLocation(program, "material.Kd")};
-  auto materialKsLoc{glGetUniformLocation(program, "material.Ks")};
-  auto materialNsLoc{glGetUniformLocation(program, "material.Ns")};
-  auto materialNiLoc{glGetUniformLocation(program, "material.Ni")};
-  auto materialDLoc{glGetUniformLocation(program, "material.d")};
-  auto selectedLoc{glGetUniformLocation(program, "selected")};
-  auto texturedLoc{glGetUniformLocation(program, "textured")};
-  auto lightCountLoc{glGetUniformLocation(program, "lightCount")};
-  auto toneMapLoc{glGetUniformLocation(program, "toneMap")};
-  auto wireframeLoc{glGetUniformLocation(program, "wireframe")};
-  auto desaturateLoc{glGetUniformLocation(program, "desaturate")};
-  auto ambientLoc{glGetUniformLocation(program, "ambient")};
-  GLuint lightColorLocs[100];
-  GLuint lightTransformLocs[100];
-  for (int i = 0; i < 100; ++i) {
-    char uniformName[23];
-    sprintf_s(uniformName, "lights[%d].color", i);
-    lightColorLocs[i] = glGetUniformLocation(program, uniformName);
-    sprintf_s(uniformName, "lights[%d].transform", i);
-    lightTransformLocs[i] = glGetUniformLocation(program, uniformName);
+  bool uWasPressedInPrevFrame = false;
+  unsigned drawCalls{};
+  // binds of the last frame, and those skipped as already in place
+  struct {
+    unsigned programs, textures, skipped;
+  } stateChanges{};
+  GLuint currentProgram{}, currentTexture{};
+
+  // every program comes in variants, picked by the rendering options and by
+  // what is being drawn; all read the same frame uniforms
+  FrameUniformBuffer frameUniforms;
+  // forward shading, also drawing wireframes and the selection outline
+  ShaderPermutations forwardPrograms{
+      "forward",
+      {frameBlock, objectsBlock, triangleMeshVertexShader},
+      {frameBlock, shadingFunctions, triangleMeshFragShader}};
+  // deferred shading: a geometry pass filling the G-buffer, then a lighting
+  // pass over the whole screen
+  ShaderPermutations gBufferPrograms{
+      "g_buffer",
+      {frameBlock, objectsBlock, triangleMeshVertexShader},
+      {triangleMeshGBufferFragShader}};
+  ShaderPermutations lightingPrograms{
+      "lighting",
+      {fullScreenVertexShader},
+      {frameBlock, shadingFunctions, deferredLightingFragShader}};
+  // depth pre-pass, writing depth alone
+  ShaderPermutations depthPrograms{
+      "depth", {frameBlock, objectsBlock, depthOnlyVertexShader}, {}};
+
+  // scripted runs draw into a framebuffer of their own, read back after every
+  // frame, and time every frame with a pair of timestamps
+  std::optional<OffscreenTarget> offscreen;
+  std::optional<PortablePixelMap> frameImage;
+  std::vector<FrameTiming> timings;
+  GLuint frameQueries[2]{}, output{};
+  unsigned frame{};
+  if (script) {
+    offscreen.emplace();
+    offscreen->resize(GLsizei(window.width()), GLsizei(window.height()));
+    frameImage.emplace(window.width(), window.height());
+    glCheck(glGenQueries(2, frameQueries));
+    output = offscreen->framebuffer();
   }
 
   glCheck(glEnable(GL_DEPTH_TEST));
@@ -279,27 +346,72 @@ void Scene::render(const Window &window, const std::function<void()> &f) {
 
   logMsg("[INFO] Starting rendering loop\n");
   window.show();
-  while (!window.shouldClose()) {
+  while (script ? frame < script->frameCount : !window.shouldClose()) {
     auto start = std::chrono::steady_clock::now();
+    PROFILE_FRAME();
+    PROFILE_ZONE("Scene::render");
+    profiler.beginFrame();
 
     glClearColor(ambient.x, ambient.y, ambient.z, 1);
 
+    // picking up actors added since the last frame, be it by the menus or
+    // within f()
+    if (!_newActors.empty()) {
+      profiler.begin("resource upload");
+      transferActors(resources, _newActors);
+      profiler.end();
+      for (auto actor : _newActors) culler.add(actor);
+      _newActors.clear();
+    }
+
     // GUI
     ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
+    window.newUiFrame();
     ImGui::NewFrame();
 
     // show FPS regardless of UI state
     ImGui::SetNextWindowPos({21, 21});
-    ImGui::SetNextWindowSize({100, 75});
+    ImGui::SetNextWindowSize({220, 0});
     if (ImGui::Begin("Performance")) {
       ImGui::Text("%.2f fps", 1.0f / _timeStep);
       ImGui::Text("%.2f s", elapsedTime);
+      ImGui::Text("%u draw calls", drawCalls);
+      ImGui::Text("%u program, %u texture binds", stateChanges.programs,
+                  stateChanges.textures);
+      ImGui::Text("%u binds skipped", stateChanges.skipped);
+      ImGui::Text("%zu program variants",
+                  forwardPrograms.variantCount() +
+                      gBufferPrograms.variantCount() +
+                      lightingPrograms.variantCount() +
+                      depthPrograms.variantCount());
+      ImGui::Text("%.2f KiB streamed", batcher.bytesStreamed() / 1024.0f);
+      ImGui::Text("%zu drawn, %zu culled", visible.size(),
+                  _actors.size() - visible.size());
+      ImGui::Text("%u lights/froxel max", lightClusters.maxLightsPerCluster());
+      auto &fragments{options.depthPrepass ? fragmentsWithPrepass
+                                           : fragmentsWithoutPrepass};
+      ImGui::Text("%.0fk fragments shaded", 1e-3 * fragments.average());
+      if (fragmentsWithPrepass.average() && fragmentsWithoutPrepass.average())
+        ImGui::Text("%.0f%% saved by pre-pass",
+                    100 * (1 - fragmentsWithPrepass.average() /
+                                   fragmentsWithoutPrepass.average()));
+      // GPU time of every pass over the last frames
+      ImGui::Separator();
+      for (size_t i = 0; i < profiler.passCount(); ++i) {
+        auto stats{profiler.stats(i)};
+        ImGui::Text("%s: %.2f ms, p95 %.2f", profiler.passName(i).c_str(),
+                    stats.average, stats.p95);
+      }
+      if (ImGui::Button("Export CSV") && !profiler.exportCsv("gpu_passes.csv"))
+        logMsg("[ERROR] Couldn't export pass timings\n");
       ImGui::End();
     }
 
     if (drawUserInterface) {
-      makeMainMenu(this, window, buffers, textures, objAmt);
+      makeMainMenu(this, window);
+#ifndef NO_CPU_PROFILER
+      makeFlameView(window, zones);
+#endif
 
       ImGui::SetNextWindowPos({0.75f * window.width(), 20});
       ImGui::SetNextWindowSize(
@@ -312,54 +424,71 @@ void Scene::render(const Window &window, const std::function<void()> &f) {
               auto it{_actors.end()};
               for (auto &actor : _actors) {
                 if (ImGui::MenuItem(actor->name().c_str()))
-                  _currentObject = actor;
+                  _selected = {actor, actor};
                 if (ImGui::BeginPopupContextItem()) {
                   if (ImGui::MenuItem("Remove")) {
-                    if (_currentObject == actor) _currentObject = nullptr;
+                    if (_selected.object == actor) _selected = {};
                     it = std::find(_actors.begin(), _actors.end(), actor);
-                    transferActors(buffers, textures, objAmt, _actors);
                   }
                   ImGui::EndPopup();
                 }
               }
               if (it != _actors.end()) {
+                auto actor{*it};
+                // only what no other actor uses leaves the GPU
+                resources.release(actor);
+                culler.remove(actor);
+                std::erase(_newActors, actor);
+                _graph.remove(actor);
                 _actors.erase(it);
-                transferActors(buffers, textures, objAmt, _actors);
+                // what the scene made goes back to its pool
+                if (_created.erase(actor)) _actorPool.destroy(actor);
               }
             }
             if (ImGui::CollapsingHeader("Cameras",
                                         ImGuiTreeNodeFlags_DefaultOpen)) {
               auto it{_cameras.end()};
               for (auto &cam : _cameras) {
-                if (ImGui::MenuItem(cam->name().c_str())) _currentObject = cam;
+                if (ImGui::MenuItem(cam->name().c_str()))
+                  _selected = {cam, nullptr, cam};
                 if (_cameras.size() > 1) {
                   if (ImGui::BeginPopupContextItem()) {
                     if (ImGui::MenuItem("Remove")) {
-                      if (_currentObject == cam) _currentObject = nullptr;
+                      if (_selected.object == cam) _selected = {};
                       it = std::find(_cameras.begin(), _cameras.end(), cam);
                     }
                     ImGui::EndPopup();
                   }
                 }
               }
-              if (it != _cameras.end()) _cameras.erase(it);
+              if (it != _cameras.end()) {
+                auto camera{*it};
+                _graph.remove(camera);
+                _cameras.erase(it);
+                if (_created.erase(camera)) _cameraPool.destroy(camera);
+              }
             }
             if (ImGui::CollapsingHeader("Lights",
                                         ImGuiTreeNodeFlags_DefaultOpen)) {
-              if (ImGui::Button("Add light")) addLight(new Light{vec3{1}});
+              if (ImGui::Button("Add light")) createLight(Light{vec3{1}});
               auto it{_lights.end()};
               for (auto light : _lights) {
                 if (ImGui::MenuItem(light->name().c_str()))
-                  _currentObject = light;
+                  _selected = {light, nullptr, nullptr, light};
                 if (ImGui::BeginPopupContextItem()) {
                   if (ImGui::MenuItem("Remove")) {
-                    if (_currentObject == light) _currentObject = nullptr;
+                    if (_selected.object == light) _selected = {};
                     it = std::find(_lights.begin(), _lights.end(), light);
                   }
                   ImGui::EndPopup();
                 }
               }
-              if (it != _lights.end()) _lights.erase(it);
+              if (it != _lights.end()) {
+                auto light{*it};
+                _graph.remove(light);
+                _lights.erase(it);
+                if (_created.erase(light)) _lightPool.destroy(light);
+              }
             }
             ImGui::EndTabItem();
           }
@@ -368,6 +497,7 @@ void Scene::render(const Window &window, const std::function<void()> &f) {
               glClearColor(ambient.x, ambient.y, ambient.z, 1);
             ImGui::Checkbox("Desaturate bright colors", &options.desaturate);
             ImGui::Checkbox("Perform tone mapping", &options.toneMap);
+            ImGui::Checkbox("Physically based shading", &options.pbr);
             ImGui::EndTabItem();
           }
           ImGui::EndTabBar();
@@ -380,47 +510,56 @@ void Scene::render(const Window &window, const std::function<void()> &f) {
       ImGui::SetNextWindowSize(
           {0.25f * window.width(), 0.5f * window.height() - 20});
       if (ImGui::Begin("Object properties", nullptr)) {
-        if (_currentObject) {
-          ImGui::Text("Selected object: %s", _currentObject->name().c_str());
+        if (_selected.object) {
+          ImGui::Text("Selected object: %s", _selected.object->name().c_str());
           if (ImGui::CollapsingHeader("Transform",
                                       ImGuiTreeNodeFlags_DefaultOpen)) {
-            auto pos{_currentObject->position()};
+            auto pos{_selected.object->position()};
             if (ImGui::DragFloat3("Position", &pos.x, 0.1f)) {
-              _currentObject->translate(
-                  vec4{pos - _currentObject->position(), 0});
-              if (auto cam{dynamic_cast<Camera *>(_currentObject)})
-                cam->updateWorldToCamera();
+              _selected.object->translate(
+                  vec4{pos - _selected.object->position(), 0});
+              if (_selected.camera) _selected.camera->updateWorldToCamera();
             }
-            vec3 rotation{_currentObject->rotation()};
+            vec3 rotation{_selected.object->rotation()};
             if (ImGui::DragFloat3("Rotation", &rotation.x, 0.01f, -1e3, 1e3,
                                   "XYZ")) {
-              auto tmp{rotation - _currentObject->rotation()};
-              _currentObject->rotate(tmp);
-              if (auto cam{dynamic_cast<Camera *>(_currentObject)})
-                cam->updateWorldToCamera();
+              auto tmp{rotation - _selected.object->rotation()};
+              _selected.object->rotate(tmp);
+              if (_selected.camera) _selected.camera->updateWorldToCamera();
             }
-            vec3 scale{_currentObject->scale()};
+            vec3 scale{_selected.object->scale()};
             if (ImGui::DragFloat3("Scale", &scale.x, 0.1f, 0.001f, 1e5f))
-              _currentObject->setScale(scale);
+              _selected.object->setScale(scale);
           }
 
-          if (auto actor{dynamic_cast<Actor *>(_currentObject)}) {
+          if (auto actor{_selected.actor}) {
             if (ImGui::CollapsingHeader("Material",
                                         ImGuiTreeNodeFlags_DefaultOpen)) {
-              ImGui::ColorEdit3("Ambient (Ka)", &actor->material.Ka.x);
-              ImGui::ColorEdit3("Diffuse (Kd)", &actor->material.Kd.x);
-              ImGui::ColorEdit3("Specular (Ks)", &actor->material.Ks.x);
-              ImGui::DragFloat("Shininess (Ns)", &actor->material.Ns, 0.1, 0);
+              ImGui::ColorEdit3("Ambient (Ka)", &actor->material().Ka.x);
+              ImGui::ColorEdit3("Diffuse (Kd)", &actor->material().Kd.x);
+              ImGui::ColorEdit3("Specular (Ks)", &actor->material().Ks.x);
+              ImGui::DragFloat("Shininess (Ns)", &actor->material().Ns, 0.1,
+                               0);
+            }
+            if (ImGui::CollapsingHeader("Rendering",
+                                        ImGuiTreeNodeFlags_DefaultOpen)) {
+              if (bool occluder{actor->occluder()};
+                  ImGui::Checkbox("Occluder", &occluder))
+                actor->setOccluder(occluder);
+              if (bool tight{actor->boundsMode() == Actor::BoundsMode::tight};
+                  ImGui::Checkbox("Tight bounds", &tight))
+                actor->setBoundsMode(tight ? Actor::BoundsMode::tight
+                                           : Actor::BoundsMode::fast);
             }
           }
-          if (auto light{dynamic_cast<Light *>(_currentObject)}) {
+          if (auto light{_selected.light}) {
             if (ImGui::CollapsingHeader("Light properties",
                                         ImGuiTreeNodeFlags_DefaultOpen)) {
               ImGui::ColorEdit3("Color", &light->color.x);
               ImGui::DragFloat("Intensity", &light->intensity, 0.1f, 0, 1e10);
             }
           }
-          if (auto cam{dynamic_cast<Camera *>(_currentObject)}) {
+          if (auto cam{_selected.camera}) {
             if (ImGui::CollapsingHeader("Camera properties",
                                         ImGuiTreeNodeFlags_DefaultOpen)) {
               if (auto fov{cam->fov()};
@@ -449,18 +588,28 @@ void Scene::render(const Window &window, const std::function<void()> &f) {
       }
       ImGui::End();
 
-      ImGui::SetNextWindowPos({0, 0.75f * window.height()});
-      ImGui::SetNextWindowSize(
-          {0.75f * window.width(), 0.25f * window.height()});
-      if (ImGui::Begin("log", nullptr,
-                       ImGuiWindowFlags_NoTitleBar |
-                           ImGuiWindowFlags_AlwaysVerticalScrollbar |
-                           ImGuiWindowFlags_NoResize)) {
-        ImGui::Text(globalLog.c_str());
-      }
-      ImGui::End();
+      makeLogView(window);
     }
 
+    // wireframes are always drawn forward and without a pre-pass, as lines
+    // don't land on the depths of the triangles they outline
+    auto deferred{options.deferredShading && !options.wireframe};
+    auto prepass{options.depthPrepass && !options.wireframe};
+    // the window's framebuffer is multisampled, which the G-buffer's depth
+    // can't be blitted into, so deferred frames go through a target of the
+    // G-buffer's kind, copied to the window once drawn
+    auto target{output};
+    if (deferred && !script) {
+      if (!offscreen) offscreen.emplace();
+      offscreen->resize(GLsizei(window.width()), GLsizei(window.height()));
+      target = offscreen->framebuffer();
+    }
+
+    glCheck(glBindFramebuffer(GL_FRAMEBUFFER, target));
+    // every target is the window's size; headless contexts start with an
+    // empty viewport, and nothing resizes them to set it
+    glCheck(glViewport(0, 0, GLsizei(window.width()),
+                       GLsizei(window.height())));
     glCheck(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
     // DEBUG CONTROLS
@@ -503,114 +652,250 @@ void Scene::render(const Window &window, const std::function<void()> &f) {
     }
     //  END OF DEBUG CONTROLS
 
-    // light uniforms
-    unsigned l{};
-    for (auto &light : _lights) {
-      auto trueLightColor{light->intensity * light->color};
-      glCheck(glUniform3fv(lightColorLocs[l], 1, &trueLightColor.x));
-      glCheck(glUniformMatrix4fv(lightTransformLocs[l], 1, GL_FALSE,
-                                 &light->transform()[0].x));
-      ++l;
+    if (script) {
+      script->cameraPath(*_cameras[0], frame * script->timeStep);
+      glCheck(glQueryCounter(frameQueries[0], GL_TIMESTAMP));
     }
-    glUniform1ui(lightCountLoc, l);
-
-    glCheck(glUniform3fv(ambientLoc, 1, &ambient.x));
-    glCheck(glUniformMatrix4fv(vLoc, 1, GL_FALSE,
-                               &_cameras[0]->worldToCamera()[0].x));
-    glCheck(glUniformMatrix4fv(pLoc, 1, GL_FALSE,
-                               &_cameras[0]->perspective()[0].x));
-
-    // UI state and rendering options
-    glCheck(glUniform1i(toneMapLoc, GLint(options.toneMap)));
-    glCheck(glUniform1i(wireframeLoc, GLint(options.wireframe)));
-    glCheck(glUniform1i(desaturateLoc, GLint(options.desaturate)));
-
-    unsigned i = 0;
-    for (auto obj : _actors) {
-      // adding VBOs to VAO
-      glCheck(glBindBuffer(GL_ARRAY_BUFFER, buffers[i]));
-      glCheck(glEnableVertexAttribArray(0));
-      glCheck(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr));
-      glCheck(glBindBuffer(GL_ARRAY_BUFFER, buffers[i + objAmt]));
-      glCheck(glEnableVertexAttribArray(1));
-      glCheck(glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr));
-      if (!obj->material.map_Kd.empty()) {
-        glCheck(glBindBuffer(GL_ARRAY_BUFFER, buffers[i + 2 * objAmt]));
-        glCheck(glEnableVertexAttribArray(2));
-        glCheck(glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, nullptr));
-        glCheck(glBindTexture(GL_TEXTURE_2D, textures[i]));
-      }
 
-      // adding EBO to VAO
-      glCheck(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[i + 3 * objAmt]));
-
-      if (auto actor{dynamic_cast<Actor *>(obj)}) {
-        auto currentActorIsSelected{dynamic_cast<Actor *>(_currentObject) ==
-                                    actor};
-
-        // uniforms
-        glCheck(
-            glUniformMatrix4fv(mLoc, 1, GL_FALSE, &actor->transform()[0].x));
-        glCheck(glUniform3fv(materialKaLoc, 1, &actor->material.Ka.x));
-        glCheck(glUniform3fv(materialKdLoc, 1, &actor->material.Kd.x));
-        glCheck(glUniform3fv(materialKsLoc, 1, &actor->material.Ks.x));
-        glCheck(glUniform1f(materialNsLoc, actor->material.Ns));
-        glCheck(glUniform1f(materialNiLoc, actor->material.Ni));
-        glCheck(glUniform1f(materialDLoc, actor->material.d));
-        glUniform1i(selectedLoc, 0);
-        glCheck(
-            glUniform1i(texturedLoc, GLint(!actor->material.map_Kd.empty())));
-
-        // drawing elements
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL - options.wireframe);
-        glCheck(glDrawElements(GL_TRIANGLES,
-                               3 * GLsizei(actor->mesh->triangles().size()),
-                               GL_UNSIGNED_INT, nullptr));
-
-        if (currentActorIsSelected && !options.wireframe) {
-          glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-          glUniform1i(selectedLoc, 1);
-          glDrawElements(GL_TRIANGLES,
-                         3 * GLsizei(actor->mesh->triangles().size()),
-                         GL_UNSIGNED_INT, nullptr);
+    // children follow whatever moved their parents since the last frame,
+    // rebounding and, for cameras, updating their views as they do
+    _graph.update();
+    ActorRegistry::instance().syncTransforms();
+
+    // every fragment shades with the lights reaching its froxel only
+    lightClusters.build(_lights, *_cameras[0]);
+
+    // only actors overlapping the view frustum and not hidden behind the
+    // occluders are submitted
+    auto viewProjection{_cameras[0]->perspective() *
+                        _cameras[0]->worldToCamera()};
+    culler.refit();
+    if (options.frustumCulling)
+      culler.cull(Frustum::fromMatrix(viewProjection), visible);
+    else
+      visible.assign(_actors.begin(), _actors.end());
+    if (options.occlusionCulling) {
+      occluders.clear();
+      for (auto actor : visible)
+        if (actor->occluder()) occluders.push_back(actor);
+      occlusionCuller.render(occluders, viewProjection);
+      occlusionCuller.cull(visible);
+    }
+    // every item is keyed by the state it is drawn with and, when ordering
+    // front to back, its depth, so that drawing in key order changes states
+    // least and lets farther fragments fail the depth test early
+    auto view{_cameras[0]->worldToCamera()};
+    queue.clear();
+    for (auto actor : visible) {
+      auto depth{options.frontToBack
+                     ? -(view * vec4{actor->bounds().center(), 1}).z
+                     : 0.0f};
+      // the variant features that vary per actor make up its program
+      auto features{actor->material().map_Kd.empty()
+                        ? 0u
+                        : unsigned(ShaderPermutations::textured)};
+      queue.push(actor, RenderQueue::opaque, features, depth);
+      // the outline goes on top of the selected actor, after everything
+      if (actor == _selected.actor && !options.wireframe)
+        queue.push(actor, RenderQueue::outline, 0, depth);
+    }
+    queue.sort();
+    profiler.begin("frame upload");
+    batcher.upload(queue);
+    multiDraw.build(batcher.batches(), resources);
+
+    auto perspective{_cameras[0]->perspective()};
+    FrameUniforms uniforms{view, perspective, inverse(perspective),
+                           vec4{ambient, 1}};
+    lightClusters.setUniforms(uniforms);
+    uniforms.firstObject = batcher.firstObject();
+
+    // the whole scene comes from the same buffers, bound once
+    frameUniforms.update(uniforms);
+    profiler.end();
+    resources.arena().bind();
+    multiDraw.bind();
+    batcher.bind();
+    lightClusters.bind();
+
+    // options every shaded variant drawn this frame shares
+    auto frameFeatures{0u};
+    if (options.toneMap) frameFeatures |= ShaderPermutations::toneMap;
+    if (options.desaturate) frameFeatures |= ShaderPermutations::desaturate;
+    if (options.pbr) frameFeatures |= ShaderPermutations::pbr;
+
+    drawCalls = 0;
+    stateChanges = {};
+    currentProgram = currentTexture = 0;
+
+    auto useProgram{[&](GLuint next) {
+      if (next == currentProgram) {
+        ++stateChanges.skipped;
+        return;
+      }
+      glCheck(glUseProgram(next));
+      currentProgram = next;
+      ++stateChanges.programs;
+    }};
+    auto bindTexture{[&](GLuint texture) {
+      if (texture == currentTexture) {
+        ++stateChanges.skipped;
+        return;
+      }
+      glCheck(glBindTexture(GL_TEXTURE_2D, texture));
+      currentTexture = texture;
+      ++stateChanges.textures;
+    }};
+    // draws the ranges of the pass with the variants of the given features,
+    // textured ones adding their texture when textured is set
+    auto drawPass{[&](RenderQueue::Pass pass, ShaderPermutations &programs,
+                      unsigned features, bool textured) {
+      for (auto &range : multiDraw.ranges()) {
+        if (range.pass != pass) continue;
+        auto variant{features};
+        if (textured && !range.texture->empty()) {
+          bindTexture(resources.texture(*range.texture));
+          variant |= ShaderPermutations::textured;
         }
-      } else {
-        logMsg(
-            "[WARNING] Attempted to draw unsupported shape, ignoring "
-            "request\n");
+        useProgram(programs.program(variant));
+        multiDraw.draw(range);
+        ++drawCalls;
       }
-      ++i;
+    }};
+
+    // lays down the depth of the nearest surfaces alone, so that the pass
+    // after it, testing for equal depths, shades every pixel once
+    auto drawDepth{[&] {
+      profiler.begin("depth pre-pass");
+      glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+      glCheck(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+      drawPass(RenderQueue::opaque, depthPrograms, 0, false);
+      profiler.end();
+      glCheck(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+      glCheck(glDepthFunc(GL_EQUAL));
+      glCheck(glDepthMask(GL_FALSE));
+    }};
+    auto endDepthTest{[] {
+      glCheck(glDepthFunc(GL_LESS));
+      glCheck(glDepthMask(GL_TRUE));
+    }};
+
+    auto &fragments{prepass ? fragmentsWithPrepass : fragmentsWithoutPrepass};
+    fragments.begin();
+
+    if (deferred) {
+      // geometry pass, keeping the nearest surface of every pixel
+      gBuffer.resize(GLsizei(window.width()), GLsizei(window.height()));
+      gBuffer.bind();
+      glCheck(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+      if (prepass) drawDepth();
+      profiler.begin("geometry");
+      glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+      drawPass(RenderQueue::opaque, gBufferPrograms, 0, true);
+      profiler.end();
+      if (prepass) endDepthTest();
+      glCheck(glBindFramebuffer(GL_FRAMEBUFFER, target));
+
+      // lighting pass, shading each covered pixel once
+      profiler.begin("lighting");
+      useProgram(lightingPrograms.program(frameFeatures));
+      gBuffer.bindTextures(1);
+      glCheck(glDisable(GL_DEPTH_TEST));
+      glCheck(glDrawArrays(GL_TRIANGLES, 0, 3));
+      glCheck(glEnable(GL_DEPTH_TEST));
+      ++drawCalls;
+
+      // so that the outline is hidden where it should be
+      gBuffer.blitDepth(target);
+      profiler.end();
     }
 
-    auto prevActorAmount{_actors.size()};
+    if (!deferred && prepass) drawDepth();
+
+    if (!deferred) {
+      profiler.begin("opaque");
+      glPolygonMode(GL_FRONT_AND_BACK, GL_FILL - options.wireframe);
+      if (options.wireframe)
+        drawPass(RenderQueue::opaque, forwardPrograms,
+                 ShaderPermutations::wireframe, false);
+      else
+        drawPass(RenderQueue::opaque, forwardPrograms, frameFeatures, true);
+      profiler.end();
+      if (prepass) endDepthTest();
+    }
+
+    // outlining the selected actor on top of its own instance, pulled
+    // slightly towards the camera to win over the faces it outlines
+    profiler.begin("outline");
+    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    glCheck(glEnable(GL_POLYGON_OFFSET_LINE));
+    glCheck(glPolygonOffset(-1, -1));
+    drawPass(RenderQueue::outline, forwardPrograms,
+             ShaderPermutations::selected, false);
+    glCheck(glDisable(GL_POLYGON_OFFSET_LINE));
+    profiler.end();
+
+    fragments.end();
+    batcher.endFrame();
+
+    if (script) {
+      glCheck(glQueryCounter(frameQueries[1], GL_TIMESTAMP));
+      auto submitted{steady_clock::now()};
+      // waiting for the GPU to be done
+      GLuint64 gpuStart{}, gpuEnd{};
+      glCheck(
+          glGetQueryObjectui64v(frameQueries[0], GL_QUERY_RESULT, &gpuStart));
+      glCheck(glGetQueryObjectui64v(frameQueries[1], GL_QUERY_RESULT, &gpuEnd));
+      timings.push_back(
+          {1e-3 * duration_cast<microseconds>(submitted - start).count(),
+           1e-6 * double(gpuEnd - gpuStart)});
+      if (!script->framePrefix.empty()) {
+        char suffix[16];
+        sprintf_s(suffix, "%04u.ppm", frame);
+        offscreen->read(*frameImage);
+        if (!frameImage->write(script->framePrefix + suffix))
+          logMsg("[ERROR] Couldn't save frame %u\n", frame);
+      }
+      ++frame;
+    }
 
     // calling custom loop function after drawing
     f();
 
-    // just in case the user dynamically adds more actors within f()
-    if (_actors.size() != prevActorAmount)
-      transferActors(buffers, textures, prevActorAmount, _actors);
-
-    // GUI
+    // GUI, which a scripted run builds but never draws
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-    window.swapBuffers();
+    if (!script) {
+      PROFILE_ZONE("present");
+      if (target != output) offscreen->copyTo(output);
+      profiler.begin("ui");
+      ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+      profiler.end();
+      window.swapBuffers();
+    }
+    profiler.endFrame();
     window.pollEvents();
 
     auto end = steady_clock::now();
-    _timeStep = 1e-6f * duration_cast<microseconds>(end - start).count();
+    _timeStep = script ? script->timeStep
+                       : 1e-6f *
+                             duration_cast<microseconds>(end - start).count();
     elapsedTime += _timeStep;
   }
 
-  glCheck(glDeleteShader(vsLoc));     // vs in vram, freeing ram
-  glCheck(glDeleteShader(fsLoc));     // fs in vram, freeing ram
-  glCheck(glDeleteProgram(program));  // program in vram, freeing ram
+  if (script) {
+    glCheck(glDeleteQueries(2, frameQueries));
+    if (!script->timingsFile.empty())
+      writeTimings(script->timingsFile, timings);
+    // the last frames' passes are still in flight
+    profiler.flush();
+    if (!script->passTimingsFile.empty() &&
+        !profiler.exportCsv(script->passTimingsFile))
+      logMsg("[ERROR] Couldn't export pass timings\n");
+  }
 
   logMsg("[INFO] Rendering loop ended\n");
   logMsg("[INFO] Freeing GPU memory\n");
-
-  glCheck(glDeleteBuffers(3 * GLsizei(objAmt), buffers.get()));
+  // meshes, textures and programs are freed along with their owners
   logMsg("[INFO] Done\n");
   logMsg("[INFO] Freeing CPU memory\n");
   logMsg("[INFO] Done\n");
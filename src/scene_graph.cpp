@@ -0,0 +1,163 @@
+#include "scene_graph.hpp"
+
+#include <type_traits>
+#include <utility>
+
+#include "cpu_profiler.hpp"
+#include "custom_assert.hpp"
+#include "job_system.hpp"
+
+SceneGraph::~SceneGraph() {
+  for (auto object : _objects) {
+    if (!object) continue;
+    object->_graph = nullptr;
+    object->_node = null;
+  }
+}
+
+void SceneGraph::add(TransformableObject *object) {
+  ASSERT(!object->_graph, "%s is already in a scene graph\n",
+         object->name().c_str());
+  object->_graph = this;
+  object->_node = int(_objects.size());
+  _objects.push_back(object);
+  _parents.push_back(null);
+  _locals.push_back(object->transform());
+  _worlds.push_back(object->transform());
+  _dirty.push_back(true);
+  _sorted = false;
+}
+
+void SceneGraph::setParent(TransformableObject *object,
+                           TransformableObject *parent) {
+  ASSERT(object->_graph == this, "%s is not in this scene graph\n",
+         object->name().c_str());
+  auto node{object->_node}, parentNode{null};
+  if (parent) {
+    ASSERT(parent->_graph == this, "%s is not in this scene graph\n",
+           parent->name().c_str());
+    parentNode = parent->_node;
+    for (auto p{parentNode}; p != null; p = _parents[p])
+      ASSERT(p != node, "%s is under %s already\n", parent->name().c_str(),
+             object->name().c_str());
+  }
+  _parents[node] = parentNode;
+  _markDirty(node);
+  _sorted = false;
+}
+
+void SceneGraph::remove(TransformableObject *object) {
+  ASSERT(object->_graph == this, "%s is not in this scene graph\n",
+         object->name().c_str());
+  // its children are found and made roots by the next sort
+  _objects[object->_node] = nullptr;
+  object->_graph = nullptr;
+  object->_node = null;
+  _sorted = false;
+}
+
+void SceneGraph::update() {
+  PROFILE_ZONE("SceneGraph::update");
+  if (!_sorted) _sort();
+
+  // no subtree depends on another, and within one parents come before their
+  // children, so every subtree is swept in order, next to the others
+  JobSystem::instance().parallelFor(
+      0, _rootDirty.size(), 64, [this](size_t first, size_t last) {
+        for (auto r = first; r < last; ++r) {
+          if (!_rootDirty[r]) continue;
+          _rootDirty[r] = false;
+          for (auto i = _roots[r]; i < _roots[r + 1]; ++i) {
+            auto parent{_parents[i]};
+            bool dirty{bool(_dirty[i])};
+            _moved[i] = dirty || (parent != null && _moved[parent]);
+            if (!_moved[i]) continue;
+            if (dirty) {
+              _locals[i] = _objects[i]->transform();
+              _dirty[i] = false;
+            }
+            if (parent == null) {
+              _worlds[i] = _locals[i];
+            } else {
+              _worlds[i] = _worlds[parent] * _locals[i];
+              _objects[i]->_worldChanged();
+            }
+          }
+        }
+      });
+}
+
+void SceneGraph::_markDirty(int node) {
+  _dirty[node] = true;
+  if (_sorted) _rootDirty[_rootOf[node]] = true;
+}
+
+void SceneGraph::_sort() {
+  PROFILE_ZONE("SceneGraph::_sort");
+  auto count{int(_objects.size())};
+  for (int i = 0; i < count; ++i) {
+    if (!_objects[i] || _parents[i] == null || _objects[_parents[i]]) continue;
+    _parents[i] = null;
+    _dirty[i] = true;
+  }
+
+  // the children of node i are children[first[i]] to children[first[i + 1]],
+  // in the order they were in
+  std::vector<int> first(count + 1), children;
+  for (int i = 0; i < count; ++i)
+    if (_objects[i] && _parents[i] != null) ++first[_parents[i] + 1];
+  for (int i = 0; i < count; ++i) first[i + 1] += first[i];
+  children.resize(first[count]);
+  {
+    auto next{first};
+    for (int i = 0; i < count; ++i)
+      if (_objects[i] && _parents[i] != null)
+        children[next[_parents[i]]++] = i;
+  }
+
+  // depth first from every root, keeping the roots and siblings in order
+  std::vector<int> order, stack;
+  order.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    if (!_objects[i] || _parents[i] != null) continue;
+    stack.push_back(i);
+    while (!stack.empty()) {
+      auto node{stack.back()};
+      stack.pop_back();
+      order.push_back(node);
+      for (auto c{first[node + 1]}; c > first[node]; --c)
+        stack.push_back(children[c - 1]);
+    }
+  }
+
+  std::vector<int> newIndex(count, null);
+  for (int i = 0; i < int(order.size()); ++i) newIndex[order[i]] = i;
+  auto permute{[&](auto &values) {
+    std::remove_reference_t<decltype(values)> sorted(order.size());
+    for (size_t i = 0; i < order.size(); ++i) sorted[i] = values[order[i]];
+    values = std::move(sorted);
+  }};
+  permute(_objects);
+  permute(_parents);
+  permute(_locals);
+  permute(_worlds);
+  permute(_dirty);
+  _moved.assign(order.size(), false);
+
+  _roots.clear();
+  _rootOf.resize(order.size());
+  _rootDirty.clear();
+  for (int i = 0; i < int(order.size()); ++i) {
+    _objects[i]->_node = i;
+    if (_parents[i] == null) {
+      _roots.push_back(i);
+      _rootDirty.push_back(false);
+    } else {
+      _parents[i] = newIndex[_parents[i]];
+    }
+    _rootOf[i] = int(_roots.size() - 1);
+    _rootDirty.back() |= _dirty[i];
+  }
+  _roots.push_back(int(order.size()));
+  _sorted = true;
+}
@@ -0,0 +1,179 @@
+#include "shader_permutations.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+#include "gl_util.hpp"
+#include "log.hpp"
+
+// defined for every feature of a variant, in Feature order
+static constexpr const char *featureMacros[ShaderPermutations::featureCount]{
+    "TEXTURED", "WIREFRAME", "SELECTED", "TONE_MAP", "DESATURATE", "PBR"};
+
+// what every cached binary starts with
+struct BinaryHeader {
+  uint64_t hash;  // of everything the binary was built from
+  GLenum format;
+  GLsizei length;
+};
+
+// the draw parameters are core from 4.6 on, and come from
+// ARB_shader_draw_parameters under other names before; sources read them
+// through BASE_INSTANCE
+static const char *versionPrelude() {
+  if (GLAD_GL_VERSION_4_6)
+    return "#version 460\n"
+           "#define BASE_INSTANCE gl_BaseInstance\n";
+  return "#version 450\n"
+         "#extension GL_ARB_shader_draw_parameters : require\n"
+         "#define BASE_INSTANCE gl_BaseInstanceARB\n";
+}
+
+// FNV-1a, carried on from h
+static uint64_t hashString(uint64_t h, const char *s) {
+  for (; *s; ++s) h = (h ^ uint8_t(*s)) * 0x100000001b3;
+  return h;
+}
+
+static GLuint compileShader(GLenum type, const std::string &defines,
+                            const std::vector<const char *> &sources) {
+  std::vector<const char *> strings{defines.c_str()};
+  strings.insert(strings.end(), sources.begin(), sources.end());
+  GLuint shader;
+  glCheck(shader = glCreateShader(type));
+  glCheck(glShaderSource(shader, GLsizei(strings.size()), strings.data(),
+                         nullptr));
+  glCheck(glCompileShader(shader));
+  glCheckShaderCompilation(shader);
+  return shader;
+}
+
+ShaderPermutations::ShaderPermutations(
+    std::string name, std::vector<const char *> vertexSources,
+    std::vector<const char *> fragmentSources)
+    : _name{std::move(name)},
+      _vertexSources{std::move(vertexSources)},
+      _fragmentSources{std::move(fragmentSources)} {}
+
+ShaderPermutations::~ShaderPermutations() {
+  for (auto &[features, program] : _variants)
+    glCheck(glDeleteProgram(program));
+}
+
+GLuint ShaderPermutations::program(unsigned features) {
+  using namespace std::chrono;
+
+  auto [it, isNew]{_variants.try_emplace(features)};
+  if (!isNew) return it->second;
+
+  std::string defines{versionPrelude()};
+  for (unsigned i = 0; i < featureCount; ++i)
+    if (features & 1u << i)
+      defines += std::string{"#define "} + featureMacros[i] + "\n";
+
+  // binaries are only good for the same sources on the same driver
+  auto hash{hashString(0xcbf29ce484222325, defines.c_str())};
+  for (auto source : _vertexSources) hash = hashString(hash, source);
+  hash = hashString(hash, "\n// fragment\n");
+  for (auto source : _fragmentSources) hash = hashString(hash, source);
+  for (auto name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    hash = hashString(hash, (const char *)glGetString(name));
+
+  auto path{cacheDirectory /
+            (_name + "_" + std::to_string(features) + ".bin")};
+  if ((it->second = _load(path, hash))) {
+    logMsg("[INFO] Loaded %s variant %#x from cache\n", _name.c_str(),
+           features);
+    return it->second;
+  }
+
+  auto start{steady_clock::now()};
+  it->second = _compile(defines);
+  _save(it->second, path, hash);
+  auto end{steady_clock::now()};
+  logMsg("[INFO] Compiled %s variant %#x, took %g ms\n", _name.c_str(),
+         features, duration_cast<microseconds>(end - start).count() / 1e3f);
+  return it->second;
+}
+
+size_t ShaderPermutations::variantCount() const { return _variants.size(); }
+
+GLuint ShaderPermutations::_compile(const std::string &defines) const {
+  GLuint program;
+  glCheck(program = glCreateProgram());
+  auto vs{compileShader(GL_VERTEX_SHADER, defines, _vertexSources)};
+  glCheck(glAttachShader(program, vs));
+  // programs without a fragment shader only write depth
+  if (!_fragmentSources.empty()) {
+    auto fs{compileShader(GL_FRAGMENT_SHADER, defines, _fragmentSources)};
+    glCheck(glAttachShader(program, fs));
+    // the program keeps what it needs of it
+    glCheck(glDeleteShader(fs));
+  }
+  glCheck(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                              GL_TRUE));
+  glCheck(glLinkProgram(program));
+  glCheckProgramLinkage(program);
+  glCheck(glDeleteShader(vs));
+  return program;
+}
+
+GLuint ShaderPermutations::_load(const std::filesystem::path &path,
+                                 uint64_t hash) const {
+  std::ifstream file{path, std::ios::binary};
+  BinaryHeader header{};
+  if (!file.read((char *)&header, sizeof header) || header.hash != hash)
+    return 0;
+  // a truncated or corrupt file mustn't size the buffer
+  std::error_code error;
+  auto size{std::filesystem::file_size(path, error)};
+  if (error || header.length <= 0 ||
+      uintmax_t(header.length) > size - sizeof header)
+    return 0;
+  std::vector<char> binary(header.length);
+  if (!file.read(binary.data(), header.length)) return 0;
+
+  // drivers may stop accepting formats they once produced
+  GLint formatCount{};
+  glCheck(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount));
+  std::vector<GLint> formats(formatCount);
+  if (formatCount)
+    glCheck(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data()));
+  if (std::find(formats.begin(), formats.end(), GLint(header.format)) ==
+      formats.end())
+    return 0;
+
+  GLuint program;
+  glCheck(program = glCreateProgram());
+  // a rejected binary is no error, it only leaves the program unlinked, so
+  // whatever it raises is cleared rather than checked
+  glProgramBinary(program, header.format, binary.data(), header.length);
+  while (glGetError() != GL_NO_ERROR) continue;
+  GLint isLinked{};
+  glCheck(glGetProgramiv(program, GL_LINK_STATUS, &isLinked));
+  if (isLinked == GL_FALSE) {
+    glCheck(glDeleteProgram(program));
+    return 0;
+  }
+  return program;
+}
+
+void ShaderPermutations::_save(GLuint program,
+                               const std::filesystem::path &path,
+                               uint64_t hash) const {
+  BinaryHeader header{hash, GL_NONE, 0};
+  glCheck(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &header.length));
+  // no binary formats supported
+  if (header.length == 0) return;
+  std::vector<char> binary(header.length);
+  glCheck(glGetProgramBinary(program, header.length, nullptr, &header.format,
+                             binary.data()));
+
+  std::error_code error;
+  std::filesystem::create_directories(path.parent_path(), error);
+  std::ofstream file{path, std::ios::binary};
+  if (!file.write((const char *)&header, sizeof header) ||
+      !file.write(binary.data(), header.length))
+    logMsg("[ERROR] Couldn't cache %s\n", path.string().c_str());
+}
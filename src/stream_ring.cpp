@@ -0,0 +1,78 @@
+#include "stream_ring.hpp"
+
+#include <algorithm>
+
+#include "gl_util.hpp"
+#include "log.hpp"
+
+static void waitFor(GLsync &fence) {
+  if (!fence) return;
+  // flushing only on the first try, as the spec recommends
+  GLbitfield flags{GL_SYNC_FLUSH_COMMANDS_BIT};
+  while (true) {
+    auto status{glClientWaitSync(fence, flags, 1'000'000)};
+    if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+      break;
+    if (status == GL_WAIT_FAILED) {
+      logMsg("[ERROR] Waiting on a stream ring fence failed\n");
+      break;
+    }
+    flags = 0;
+  }
+  glCheck(glDeleteSync(fence));
+  fence = nullptr;
+}
+
+StreamRing::StreamRing(size_t elementSize, size_t capacity)
+    : _elementSize{elementSize} {
+  _allocate(capacity);
+}
+
+StreamRing::~StreamRing() { _free(); }
+
+void *StreamRing::begin(size_t count) {
+  if (count > _capacity) {
+    logMsg("[INFO] Growing stream ring to %zu elements per section\n",
+           std::max(count, 2 * _capacity));
+    _free();
+    _allocate(std::max(count, 2 * _capacity));
+  }
+
+  waitFor(_fences[_section]);
+  _bytesStreamed = count * _elementSize;
+  return (char *)_mapped + size_t(first()) * _elementSize;
+}
+
+void StreamRing::end() {
+  glCheck(_fences[_section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+  _section = (_section + 1) % sections;
+}
+
+GLuint StreamRing::first() const { return GLuint(_section * _capacity); }
+
+GLuint StreamRing::buffer() const { return _buffer; }
+
+size_t StreamRing::bytesStreamed() const { return _bytesStreamed; }
+
+void StreamRing::_allocate(size_t capacity) {
+  constexpr GLbitfield flags{GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                             GL_MAP_COHERENT_BIT};
+
+  _capacity = capacity;
+  _section = 0;
+  auto bytes{sections * _capacity * _elementSize};
+  glCheck(glGenBuffers(1, &_buffer));
+  glCheck(glBindBuffer(GL_SHADER_STORAGE_BUFFER, _buffer));
+  glCheck(glBufferStorage(GL_SHADER_STORAGE_BUFFER, bytes, nullptr, flags));
+  glCheck(_mapped =
+              glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, bytes, flags));
+}
+
+void StreamRing::_free() {
+  // nothing may be in flight when the storage goes away
+  for (auto &fence : _fences) waitFor(fence);
+  glCheck(glBindBuffer(GL_SHADER_STORAGE_BUFFER, _buffer));
+  glCheck(glUnmapBuffer(GL_SHADER_STORAGE_BUFFER));
+  glCheck(glDeleteBuffers(1, &_buffer));
+  _mapped = nullptr;
+}
@@ -1,10 +1,18 @@
 #include "triangle_mesh.hpp"
 
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <chrono>
+#include <cstring>
 #include <fstream>
-#include <sstream>
+#include <iterator>
+#include <utility>
 
+#include "convex_hull.hpp"
+#include "cpu_profiler.hpp"
 #include "custom_assert.hpp"
+#include "job_system.hpp"
 #include "log.hpp"
 
 using namespace glm;
@@ -19,58 +27,120 @@ void TriangleMeshData::addTriangle(IndexedTriangle t) {
 
 void TriangleMeshData::addUV(vec2 uv) { uvs.push_back(uv); }
 
+namespace {
+
+// what a stretch of whole lines of an OBJ file holds
+struct ObjChunk {
+  std::vector<vec3> vertices, normals;
+  // 1-based vertex and normal indices of every corner, as in v//vn
+  std::vector<std::array<unsigned, 6>> faces;
+};
+
+}  // namespace
+
+// skips blanks, then reads a number and moves past it
+template <typename T>
+static T readNumber(const char *&p, const char *end) {
+  while (p < end && (*p == ' ' || *p == '\t')) ++p;
+  T value{};
+  p = std::from_chars(p, end, value).ptr;
+  return value;
+}
+
+static void parseObjChunk(const char *p, const char *end, ObjChunk &chunk) {
+  while (p < end) {
+    auto lineEnd{static_cast<const char *>(std::memchr(p, '\n', end - p))};
+    if (!lineEnd) lineEnd = end;
+    while (p < lineEnd && (*p == ' ' || *p == '\t')) ++p;
+    if (lineEnd - p > 2 && p[0] == 'v' && p[1] == ' ') {
+      p += 2;
+      auto &v{chunk.vertices.emplace_back()};
+      for (int i = 0; i < 3; ++i) v[i] = readNumber<float>(p, lineEnd);
+    } else if (lineEnd - p > 3 && p[0] == 'v' && p[1] == 'n' && p[2] == ' ') {
+      p += 3;
+      auto &n{chunk.normals.emplace_back()};
+      for (int i = 0; i < 3; ++i) n[i] = readNumber<float>(p, lineEnd);
+    } else if (lineEnd - p > 2 && p[0] == 'f' && p[1] == ' ') {
+      p += 2;
+      auto &f{chunk.faces.emplace_back()};
+      for (int i = 0; i < 3; ++i) {
+        f[i] = readNumber<unsigned>(p, lineEnd);
+        while (p < lineEnd && *p == '/') ++p;
+        f[3 + i] = readNumber<unsigned>(p, lineEnd);
+      }
+    }
+    p = lineEnd + 1;
+  }
+}
+
 TriangleMeshData TriangleMeshData::fromObj(const std::string &file) {
   using namespace std::chrono;
+  PROFILE_ZONE("TriangleMeshData::fromObj");
 
   TriangleMeshData data;
 
-  std::ifstream is{file};
+  std::ifstream is{file, std::ios::binary};
   if (!is) {
     logMsg("[ERROR] Could not open file %s, terminating", file.c_str());
     std::terminate();
   }
 
-  std::vector<vec3> vertices, normals;
-
   logMsg("[INFO] Reading OBJ file \"%s\"...\n", file.c_str());
   auto start{steady_clock::now()};
 
-  std::string line;
-  unsigned i{};
-  while (std::getline(is, line)) {
-    std::istringstream iss{line};
-    std::string type;
-    iss >> type;
-    if (type == "v") {
-      vec3 v;
-      iss >> v.x >> v.y >> v.z;
-      vertices.push_back(v);
-    } else if (type == "vn") {
-      vec3 n;
-      iss >> n.x >> n.y >> n.z;
-      normals.push_back(n);
-    } else if (type == "f") {
-      unsigned v1, v2, v3, n1, n2, n3;
-      iss >> v1;
-      iss.ignore(2);
-      iss >> n1;
-      iss >> v2;
-      iss.ignore(2);
-      iss >> n2;
-      iss >> v3;
-      iss.ignore(2);
-      iss >> n3;
-      data.addVertex(vertices[size_t(v1) - 1]);
-      data.addVertex(vertices[size_t(v2) - 1]);
-      data.addVertex(vertices[size_t(v3) - 1]);
-      data.addNormal(normals[size_t(n1) - 1]);
-      data.addNormal(normals[size_t(n2) - 1]);
-      data.addNormal(normals[size_t(n3) - 1]);
-      data.addTriangle({i, i + 1, i + 2});
-      i += 3;
-    }
+  std::string text{std::istreambuf_iterator<char>{is},
+                   std::istreambuf_iterator<char>{}};
+
+  // chunks of whole lines are parsed in parallel; faces refer to vertices by
+  // their index in the whole file, so they are resolved once all are read
+  auto &jobs{JobSystem::instance()};
+  static constexpr size_t minChunkSize{1 << 16};
+  auto chunkCount{std::clamp<size_t>(text.size() / minChunkSize, 1,
+                                     4 * size_t(jobs.threadCount()))};
+  std::vector<size_t> bounds(chunkCount + 1, text.size());
+  bounds[0] = 0;
+  for (size_t i = 1; i < chunkCount; ++i) {
+    auto newline{text.find('\n', std::max(i * text.size() / chunkCount,
+                                          bounds[i - 1]))};
+    bounds[i] = newline == std::string::npos ? text.size() : newline + 1;
+  }
+
+  std::vector<ObjChunk> chunks(chunkCount);
+  jobs.parallelFor(0, chunkCount, 1, [&](size_t first, size_t last) {
+    for (auto i = first; i < last; ++i)
+      parseObjChunk(text.data() + bounds[i], text.data() + bounds[i + 1],
+                    chunks[i]);
+  });
+
+  std::vector<vec3> vertices, normals;
+  std::vector<size_t> firstFace(chunkCount + 1);
+  for (size_t i = 0; i < chunkCount; ++i) {
+    auto &chunk{chunks[i]};
+    vertices.insert(vertices.end(), chunk.vertices.begin(),
+                    chunk.vertices.end());
+    normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+    firstFace[i + 1] = firstFace[i] + chunk.faces.size();
   }
 
+  auto faceCount{firstFace[chunkCount]};
+  data.vertices.resize(3 * faceCount);
+  data.normals.resize(3 * faceCount);
+  data.triangles.resize(faceCount);
+  jobs.parallelFor(0, chunkCount, 1, [&](size_t first, size_t last) {
+    for (auto c = first; c < last; ++c) {
+      for (size_t f = 0; f < chunks[c].faces.size(); ++f) {
+        auto &face{chunks[c].faces[f]};
+        auto triangle{firstFace[c] + f};
+        auto i{unsigned(3 * triangle)};
+        for (unsigned k = 0; k < 3; ++k) {
+          data.vertices[i + k] = vertices[size_t(face[k]) - 1];
+          data.normals[i + k] = normals[size_t(face[3 + k]) - 1];
+        }
+        data.triangles[triangle] = {i, i + 1, i + 2};
+      }
+    }
+  });
+
   auto end{steady_clock::now()};
   logMsg("[INFO] Reading took %g s and used %zu B of memory\n",
          duration_cast<microseconds>(end - start).count() / 1e6f,
@@ -181,14 +251,18 @@ TriangleMeshData TriangleMeshData::plane() {
   return data;
 }
 
-TriangleMesh::TriangleMesh(TriangleMeshData &&data) : _data{data} {}
+TriangleMesh::TriangleMesh(TriangleMeshData &&data) : _data{std::move(data)} {
+  for (auto &v : _data.vertices) _localBounds.inflate(v);
+}
 
 // TriangleMesh::TriangleMesh(const TriangleMesh &other)
 //     : TransformableObject{other}, _vertices{other._vertices},
 //       _normals{other._normals}, _triangles{other._triangles} {}
 
 TriangleMesh::TriangleMesh(TriangleMesh &&other) noexcept
-    : _data{std::move(other._data)} {}
+    : _data{std::move(other._data)},
+      _localBounds{other._localBounds},
+      _hull{std::exchange(other._hull, std::make_unique<Hull>())} {}
 
 // TriangleMesh &TriangleMesh::operator=(const TriangleMesh &other) {
 //   if (this == &other)
@@ -204,6 +278,8 @@ TriangleMesh &TriangleMesh::operator=(TriangleMesh &&other) noexcept {
   if (this == &other)
     goto skip;
   _data = std::move(other._data);
+  _localBounds = other._localBounds;
+  _hull = std::exchange(other._hull, std::make_unique<Hull>());
 skip:
   return *this;
 }
@@ -220,4 +296,10 @@ const std::vector<IndexedTriangle> &TriangleMesh::triangles() const {
 
 const std::vector<vec2> &TriangleMesh::uv() const { return _data.uvs; }
 
+const std::vector<vec3> &TriangleMesh::hull() const {
+  std::call_once(_hull->found,
+                 [&] { _hull->vertices = convexHullVertices(_data.vertices); });
+  return _hull->vertices;
+}
+
 // if mass == 0, then assume infinite mass
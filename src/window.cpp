@@ -1,14 +1,103 @@
 #include "window.hpp"
 
-Window::Window(size_t width, size_t height, const char *title)
-    : _width{width}, _height{height} {
+#ifndef _WIN32
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstring>
+
+namespace {
+
+// a core context of the highest version there is, 4.6 or else 4.5, which is
+// all llvmpipe has (ShaderPermutations copes with either), without a window
+// or a display server behind it: on Mesa's surfaceless platform where there
+// is one, which falls back to software rendering on machines without a GPU,
+// or on the default display otherwise; it draws to no surface at all if EGL
+// allows it, or to a pbuffer
+bool createEglContext(size_t width, size_t height, void *&display,
+                      void *&surface, void *&context) {
+  auto getPlatformDisplay{reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+      eglGetProcAddress("eglGetPlatformDisplayEXT"))};
+  EGLDisplay eglDisplay{EGL_NO_DISPLAY};
+  if (getPlatformDisplay)
+    eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                    EGL_DEFAULT_DISPLAY, nullptr);
+  if (eglDisplay == EGL_NO_DISPLAY ||
+      !eglInitialize(eglDisplay, nullptr, nullptr)) {
+    eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (eglDisplay == EGL_NO_DISPLAY ||
+        !eglInitialize(eglDisplay, nullptr, nullptr))
+      return false;
+  }
+  display = eglDisplay;
+
+  auto extensions{eglQueryString(eglDisplay, EGL_EXTENSIONS)};
+  bool surfaceless{extensions &&
+                   strstr(extensions, "EGL_KHR_surfaceless_context")};
+  const EGLint configAttributes[]{
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_SURFACE_TYPE,    surfaceless ? 0 : EGL_PBUFFER_BIT,
+      EGL_NONE};
+  EGLConfig config;
+  EGLint configs{};
+  if (!eglBindAPI(EGL_OPENGL_API) ||
+      !eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configs) ||
+      !configs)
+    return false;
+
+  EGLSurface eglSurface{EGL_NO_SURFACE};
+  if (!surfaceless) {
+    const EGLint pbufferAttributes[]{EGL_WIDTH, EGLint(width), EGL_HEIGHT,
+                                     EGLint(height), EGL_NONE};
+    eglSurface = eglCreatePbufferSurface(eglDisplay, config, pbufferAttributes);
+    if (eglSurface == EGL_NO_SURFACE) return false;
+    surface = eglSurface;
+  }
+  EGLContext eglContext{EGL_NO_CONTEXT};
+  for (EGLint minor : {6, 5}) {
+    const EGLint contextAttributes[]{EGL_CONTEXT_MAJOR_VERSION_KHR,
+                                     4,
+                                     EGL_CONTEXT_MINOR_VERSION_KHR,
+                                     minor,
+                                     EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR,
+                                     EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+                                     EGL_NONE};
+    eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT,
+                                  contextAttributes);
+    if (eglContext != EGL_NO_CONTEXT) break;
+  }
+  if (eglContext == EGL_NO_CONTEXT) return false;
+  context = eglContext;
+  return eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext);
+}
+
+}  // namespace
+#endif
+
+Window::Window(size_t width, size_t height, const char *title,
+               bool headless)
+    : _width{width}, _height{height}, _headless{headless} {
+#ifndef _WIN32
+  if (headless) {
+    if (!createEglContext(width, height, _eglDisplay, _eglSurface,
+                          _eglContext)) {
+      fputs("EGL context could not be created\n", stderr);
+      exit(1);
+    }
+    if (!gladLoadGLLoader(GLADloadproc(eglGetProcAddress)))
+      fputs("GLAD could not load OpenGL\n", stderr);
+    _initializeUi();
+    return;
+  }
+#endif
   if (!glfwInit()) {
     fputs("GLFW could not be initialized\n", stderr);
     exit(1);
     // throw std::runtime_error{"GLFW could not be initialized"};
   }
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
   glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
   glfwWindowHint(GLFW_SAMPLES, 8);
@@ -35,13 +124,16 @@ Window::Window(size_t width, size_t height, const char *title)
                               glViewport(0, 0, width, height);
                             });
 
-  // ImGui
+  _initializeUi();
+}
+
+void Window::_initializeUi() {
   IMGUI_CHECKVERSION();
   ImGui::CreateContext();
   ImGuiIO &io = ImGui::GetIO();
   io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
   io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
-  ImGui_ImplGlfw_InitForOpenGL(_window, true);
+  if (_window) ImGui_ImplGlfw_InitForOpenGL(_window, true);
   ImGui_ImplOpenGL3_Init();
   auto segoeUi = io.Fonts->AddFontFromFileTTF("assets/fonts/segoeui.ttf", 16);
   if (segoeUi) {
@@ -53,35 +145,73 @@ Window::Window(size_t width, size_t height, const char *title)
 
 Window::~Window() {
   ImGui_ImplOpenGL3_Shutdown();
-  ImGui_ImplGlfw_Shutdown();
+  if (_window) ImGui_ImplGlfw_Shutdown();
   ImGui::DestroyContext();
+#ifndef _WIN32
+  if (_eglDisplay) {
+    eglMakeCurrent(_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                   EGL_NO_CONTEXT);
+    if (_eglContext) eglDestroyContext(_eglDisplay, _eglContext);
+    if (_eglSurface) eglDestroySurface(_eglDisplay, _eglSurface);
+    eglTerminate(_eglDisplay);
+    return;
+  }
+#endif
   glfwTerminate();
 }
 
 size_t Window::width() const {
+  if (!_window) return _width;
   int w, h;
   glfwGetWindowSize(_window, &w, &h);
   return w;
 }
 
 size_t Window::height() const {
+  if (!_window) return _height;
   int w, h;
   glfwGetWindowSize(_window, &w, &h);
   return h;
 }
 
-bool Window::shouldClose() const { return glfwWindowShouldClose(_window); }
-void Window::swapBuffers() const { glfwSwapBuffers(_window); }
-void Window::pollEvents() const { glfwPollEvents(); }
+// without a window, there's nothing to close, present or poll
+bool Window::shouldClose() const {
+  return _window && glfwWindowShouldClose(_window);
+}
+
+void Window::swapBuffers() const {
+  if (_window) glfwSwapBuffers(_window);
+}
+
+void Window::pollEvents() const {
+  if (_window) glfwPollEvents();
+}
 
 bool Window::keyIsPressed(int key) const {
-  return glfwGetKey(_window, key) == GLFW_PRESS;
+  return _window && glfwGetKey(_window, key) == GLFW_PRESS;
 }
 
 std::tuple<float, float> Window::getCursorPos() const {
+  if (!_window) return {0.0f, 0.0f};
   double x, y;
   glfwGetCursorPos(_window, &x, &y);
   return std::forward_as_tuple(x, y);
 }
 
-void Window::show() const { glfwShowWindow(_window); }
+void Window::show() const {
+  if (!_headless) glfwShowWindow(_window);
+}
+
+bool Window::headless() const { return _headless; }
+
+void Window::newUiFrame() const {
+  if (_window) {
+    ImGui_ImplGlfw_NewFrame();
+    return;
+  }
+  // what the GLFW backend would have set; headless runs step time by their
+  // scripts anyway
+  auto &io{ImGui::GetIO()};
+  io.DisplaySize = {float(_width), float(_height)};
+  io.DeltaTime = 1 / 60.0f;
+}